@@ -0,0 +1,185 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.CSharp;
+using Microsoft.CodeAnalysis.CSharp.Syntax;
+
+namespace Aura.Generators
+{
+    /// <summary>Emits an IScriptFunctionProvider implementation for every partial class with [ScriptFunction] methods</summary>
+    [Generator]
+    public class ScriptFunctionGenerator : IIncrementalGenerator
+    {
+        private const string AttributeName = "Aura.Script.ScriptFunctionAttribute";
+        private const string ProviderName = "Aura.Script.IScriptFunctionProvider";
+        private const string FunctionPrefix = "Scr";
+
+        private static readonly DiagnosticDescriptor ReflectionFallback = new DiagnosticDescriptor(
+            "AURA001",
+            "Script functions are registered by reflection",
+            "Script functions of {0} are registered by reflection, make it a top-level, non-generic partial class",
+            "Aura.Generators",
+            DiagnosticSeverity.Warning,
+            isEnabledByDefault: true);
+
+        private static readonly DiagnosticDescriptor HiddenByBaseProvider = new DiagnosticDescriptor(
+            "AURA002",
+            "Script functions would not be registered",
+            "{0} derives from the generated script function provider {1}, so it has to be a top-level, non-generic partial class",
+            "Aura.Generators",
+            DiagnosticSeverity.Error,
+            isEnabledByDefault: true);
+
+        private static readonly DiagnosticDescriptor InvalidReturnType = new DiagnosticDescriptor(
+            "AURA003",
+            "Invalid script function return type",
+            "Script function {0} has to return either void or Task",
+            "Aura.Generators",
+            DiagnosticSeverity.Error,
+            isEnabledByDefault: true);
+
+        public void Initialize(IncrementalGeneratorInitializationContext context)
+        {
+            var classes = context.SyntaxProvider.CreateSyntaxProvider(
+                (node, _) => node is ClassDeclarationSyntax classDecl &&
+                    classDecl.Members.OfType<MethodDeclarationSyntax>().Any(m => m.AttributeLists.Count > 0),
+                (syntaxContext, ct) => syntaxContext.SemanticModel.GetDeclaredSymbol((ClassDeclarationSyntax)syntaxContext.Node, ct))
+                .Where(type => type != null)
+                .Collect();
+            context.RegisterSourceOutput(classes.Combine(context.CompilationProvider), (output, source) =>
+            {
+                var types = source.Left
+                    .Select(t => t!)
+                    .Distinct<INamedTypeSymbol>(SymbolEqualityComparer.Default)
+                    .Where(HasScriptFunctions);
+                foreach (var type in types)
+                    Generate(output, type, source.Right);
+            });
+        }
+
+        private static void Generate(SourceProductionContext output, INamedTypeSymbol type, Compilation compilation)
+        {
+            var location = type.Locations.FirstOrDefault();
+            if (!CanGenerate(type))
+            {
+                var baseProvider = FindBaseProvider(type);
+                output.ReportDiagnostic(baseProvider == null
+                    ? Diagnostic.Create(ReflectionFallback, location, type.Name)
+                    : Diagnostic.Create(HiddenByBaseProvider, location, type.Name, baseProvider.Name));
+                return;
+            }
+
+            var task = compilation.GetTypeByMetadataName("System.Threading.Tasks.Task");
+            var registrations = new StringBuilder();
+            foreach (var method in ScriptFunctions(type))
+            {
+                bool isAsync = !method.ReturnsVoid;
+                if (isAsync && !IsAssignableTo(method.ReturnType, task))
+                {
+                    output.ReportDiagnostic(Diagnostic.Create(InvalidReturnType, method.Locations.FirstOrDefault(), method.Name));
+                    continue;
+                }
+
+                var parameterTypes = method.Parameters.Select(p => $"typeof({TypeOfName(p.Type)})");
+                var arguments = method.Parameters.Select((p, i) =>
+                    $"global::Aura.Script.Interpreter.Argument<{p.Type.ToDisplayString(SymbolDisplayFormat.FullyQualifiedFormat)}>(args[{i}])");
+                var call = $"{method.Name}({string.Join(", ", arguments)})";
+                var body = isAsync ? $"{call}" : $"{{ {call}; return null; }}";
+                foreach (var auraName in AuraNames(method))
+                {
+                    registrations.AppendLine($"            interpreter.RegisterFunction({SymbolDisplay.FormatLiteral(auraName, true)},");
+                    registrations.AppendLine($"                new global::System.Type[] {{ {string.Join(", ", parameterTypes)} }},");
+                    registrations.AppendLine($"                {(isAsync ? "true" : "false")},");
+                    registrations.AppendLine($"                args => {body});");
+                }
+            }
+
+            bool isOverride = FindBaseProvider(type) != null;
+            var modifier = isOverride ? "override " : type.IsSealed ? "" : "virtual ";
+            var source = new StringBuilder();
+            source.AppendLine("// <auto-generated/>");
+            source.AppendLine("#nullable enable");
+            if (!type.ContainingNamespace.IsGlobalNamespace)
+                source.AppendLine($"namespace {type.ContainingNamespace.ToDisplayString()}");
+            source.AppendLine("{");
+            source.AppendLine($"    partial class {type.Name} : global::{ProviderName}");
+            source.AppendLine("    {");
+            source.AppendLine($"        public {modifier}void RegisterScriptFunctions(global::Aura.Script.Interpreter interpreter)");
+            source.AppendLine("        {");
+            if (isOverride)
+                source.AppendLine("            base.RegisterScriptFunctions(interpreter);");
+            source.Append(registrations);
+            source.AppendLine("        }");
+            source.AppendLine("    }");
+            source.AppendLine("}");
+            output.AddSource($"{type.ToDisplayString()}.ScriptFunctions.g.cs", source.ToString());
+        }
+
+        private static IEnumerable<IMethodSymbol> ScriptFunctions(INamedTypeSymbol type) => type
+            .GetMembers()
+            .OfType<IMethodSymbol>()
+            .Where(m => !m.IsStatic && m.GetAttributes().Any(IsScriptFunctionAttribute));
+
+        private static bool HasScriptFunctions(INamedTypeSymbol type) => ScriptFunctions(type).Any();
+
+        private static bool IsScriptFunctionAttribute(AttributeData attribute) =>
+            attribute.AttributeClass?.ToDisplayString() == AttributeName;
+
+        private static IEnumerable<string> AuraNames(IMethodSymbol method) => method
+            .GetAttributes()
+            .Where(IsScriptFunctionAttribute)
+            .Select(a => a.ConstructorArguments.FirstOrDefault().Value as string ??
+                (method.Name.StartsWith(FunctionPrefix, StringComparison.Ordinal) ? method.Name.Substring(FunctionPrefix.Length) : method.Name));
+
+        private static bool CanGenerate(INamedTypeSymbol type)
+        {
+            if (type.ContainingType != null || type.IsGenericType)
+                return false;
+            bool isPartial = type.DeclaringSyntaxReferences
+                .Select(r => r.GetSyntax())
+                .OfType<ClassDeclarationSyntax>()
+                .All(c => c.Modifiers.Any(SyntaxKind.PartialKeyword));
+            if (!isPartial)
+                return false;
+            // base classes registered by reflection would be hidden by the generated provider
+            for (var baseType = type.BaseType; baseType != null; baseType = baseType.BaseType)
+            {
+                if (IsProvider(baseType))
+                    return true;
+                if (HasScriptFunctions(baseType))
+                    return false;
+            }
+            return true;
+        }
+
+        private static INamedTypeSymbol? FindBaseProvider(INamedTypeSymbol type)
+        {
+            for (var baseType = type.BaseType; baseType != null; baseType = baseType.BaseType)
+            {
+                if (IsProvider(baseType))
+                    return baseType;
+            }
+            return null;
+        }
+
+        private static bool IsProvider(INamedTypeSymbol type) =>
+            type.AllInterfaces.Any(i => i.ToDisplayString() == ProviderName) ||
+            (type.Locations.Any(l => l.IsInSource) && HasScriptFunctions(type) && CanGenerate(type));
+
+        private static bool IsAssignableTo(ITypeSymbol type, INamedTypeSymbol? target)
+        {
+            for (var current = type; current != null; current = current.BaseType)
+            {
+                if (SymbolEqualityComparer.Default.Equals(current, target))
+                    return true;
+            }
+            return false;
+        }
+
+        private static string TypeOfName(ITypeSymbol type) => type.IsReferenceType
+            ? type.WithNullableAnnotation(NullableAnnotation.NotAnnotated).ToDisplayString(SymbolDisplayFormat.FullyQualifiedFormat)
+            : type.ToDisplayString(SymbolDisplayFormat.FullyQualifiedFormat);
+    }
+}
@@ -4,13 +4,13 @@ namespace Aura.Script
 {
     public class CellScriptParser : Parser
     {
-        public CellScriptParser(Tokenizer tokenizer) : base(tokenizer) { }
+        public CellScriptParser(Tokenizer tokenizer, SyntaxArena? arena = null, SyntaxCache? cache = null) : base(tokenizer, arena, cache) { }
 
-        public InstructionBlockNode ParseCellScript()
+        public InstructionBlockNode ParseCellScript() => Arena.View<InstructionBlockNode>(ParseRoot(() =>
         {
             var block = ParseInstructionBlock();
             Expect(TokenType.EndOfSource);
             return block;
-        }
+        }));
     }
 }
@@ -5,30 +5,32 @@ namespace Aura.Script
 {
     public class DefaultValueListParser : Parser
     {
-        public DefaultValueListParser(Tokenizer tokenizer) : base(tokenizer) { }
+        public DefaultValueListParser(Tokenizer tokenizer, SyntaxArena? arena = null, SyntaxCache? cache = null) : base(tokenizer, arena, cache) { }
 
-        protected DefaultValueNode ParseDefaultValue()
+        protected int ParseDefaultValue()
         {
             var name = Expect(TokenType.Identifier);
             Expect(TokenType.Assign);
             var value = ParseValue();
             ContinueWith(TokenType.Semicolon); // the semicolon is optional based on GlobalSettings.def:114 -_-
-            return new DefaultValueNode(name.Pos, name.Value, value);
+            return AddNode(NodeKind.DefaultValue, name.Pos.Character, name.Pos.Character + name.Pos.Length, Arena.AddString(name.Value), value);
         }
 
         public IReadOnlyDictionary<string, DefaultValueNode> ParseDefaultValueList()
         {
-            var values = new Dictionary<string, DefaultValueNode>();
-            while(true)
+            int list = ParseRoot(() =>
             {
-                var token = Expect(TokenType.Identifier, TokenType.EndOfSource);
-                if (token.Type == TokenType.EndOfSource)
-                    return values;
-
-                PushBack(token);
-                var value = ParseDefaultValue();
+                var firstToken = Peek();
+                int mark = BeginChildren();
+                while (PeekExpected(TokenType.Identifier, TokenType.EndOfSource).Type != TokenType.EndOfSource)
+                    PushChild(ParseDefaultValue());
+                var (first, count) = EndChildren(mark);
+                return AddNode(NodeKind.List, firstToken, 0, first, count);
+            });
+            var values = new Dictionary<string, DefaultValueNode>();
+            foreach (var value in new NodeList<DefaultValueNode>(Arena, Arena.B(list), Arena.C(list)))
                 values[value.Name] = value;
-            }
+            return values;
         }
     }
 }
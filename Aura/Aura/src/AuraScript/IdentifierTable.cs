@@ -0,0 +1,78 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace Aura.Script
+{
+    /// <summary>Interns the identifiers of script texts, so repeated names are only allocated once</summary>
+    /// <remarks>The table is not thread-safe, tokenizers running in parallel need their own tables</remarks>
+    public class IdentifierTable
+    {
+        private struct Entry
+        {
+            public string value;
+            public uint hash;
+            public int next;
+        }
+
+        private int[] buckets = new int[256]; // index of the first entry plus one
+        private Entry[] entries = new Entry[256];
+        private int count;
+
+        public int Count => count;
+
+        public string Intern(ReadOnlySpan<char> text) => Intern<char>(text);
+
+        /// <summary>Interns ASCII text, bytes outside of ASCII are read as '?'</summary>
+        public string Intern(ReadOnlySpan<byte> asciiText) => Intern<byte>(asciiText);
+
+        internal string Intern<TChar>(ReadOnlySpan<TChar> text) where TChar : unmanaged
+        {
+            if (text.IsEmpty)
+                return "";
+            uint hash = 2166136261; // FNV-1a
+            for (int i = 0; i < text.Length; i++)
+                hash = (hash ^ (uint)ScriptCharacters.At(text, i)) * 16777619;
+
+            for (int i = buckets[hash & (buckets.Length - 1)] - 1; i >= 0; i = entries[i].next)
+            {
+                if (entries[i].hash == hash && AreEqual(entries[i].value, text))
+                    return entries[i].value;
+            }
+
+            var value = typeof(TChar) == typeof(byte)
+                ? Encoding.ASCII.GetString(MemoryMarshal.AsBytes(text))
+                : new string(MemoryMarshal.Cast<TChar, char>(text));
+            if (count == entries.Length)
+                Grow();
+            ref var bucket = ref buckets[hash & (buckets.Length - 1)];
+            entries[count] = new Entry { value = value, hash = hash, next = bucket - 1 };
+            bucket = ++count;
+            return value;
+        }
+
+        private static bool AreEqual<TChar>(string value, ReadOnlySpan<TChar> text) where TChar : unmanaged
+        {
+            if (value.Length != text.Length)
+                return false;
+            for (int i = 0; i < text.Length; i++)
+            {
+                if (value[i] != ScriptCharacters.At(text, i))
+                    return false;
+            }
+            return true;
+        }
+
+        private void Grow()
+        {
+            Array.Resize(ref entries, entries.Length * 2);
+            buckets = new int[buckets.Length * 2];
+            for (int i = 0; i < count; i++)
+            {
+                ref var bucket = ref buckets[entries[i].hash & (buckets.Length - 1)];
+                entries[i].next = bucket - 1;
+                bucket = i + 1;
+            }
+        }
+    }
+}
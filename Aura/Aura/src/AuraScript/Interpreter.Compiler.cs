@@ -0,0 +1,333 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace Aura.Script
+{
+    public partial class Interpreter
+    {
+        private enum OpCode : byte
+        {
+            Equals,         // pushes whether value A equals value B
+            NotEquals,      // pushes whether value A does not equal value B
+            And,            // pops two conditions, pushes whether both are true
+            Or,             // pops two conditions, pushes whether any is true
+            JumpIfFalse,    // pops a condition, jumps to A if it is false
+            Jump,           // jumps to A
+            Assign,         // sets variable A to value B
+            Call,           // calls the function of call site A
+            Return,
+            Throw           // throws error A, stands in for B pushed conditions
+        }
+
+        private enum ValueKind
+        {
+            Constant,
+            Variable,
+            Global
+        }
+
+        private readonly struct Op
+        {
+            public readonly OpCode Code;
+            public readonly int A;
+            public readonly int B;
+
+            public Op(OpCode code, int a = 0, int b = 0)
+            {
+                Code = code;
+                A = a;
+                B = b;
+            }
+
+            public override string ToString() => $"{Code} {A} {B}";
+        }
+
+        /// <summary>A flattened instruction block with all names resolved to slots</summary>
+        private class CompiledBlock
+        {
+            public Op[] ops = null!;
+            public int[] constants = null!;
+            public (IVariableSet set, int slot)[] variables = null!;
+            public Func<int>[] globals = null!;
+            public CallSite[] calls = null!;
+            public string[] errors = null!;
+            public int maxConditionDepth;
+            public int executionCount;
+            public Task<NativeBlock>? nativeTask;
+            public bool isNativeDisabled;
+
+            public int Load(int value) => (ValueKind)(value & 3) switch
+            {
+                ValueKind.Constant => constants[value >> 2],
+                ValueKind.Variable => variables[value >> 2].set[variables[value >> 2].slot],
+                ValueKind.Global => globals[value >> 2](),
+                var _ => throw new InvalidProgramException("Unknown value kind")
+            };
+        }
+
+        private class BlockCompiler
+        {
+            private readonly Interpreter interpreter;
+            private readonly List<Op> ops = new List<Op>();
+            private readonly List<int> constants = new List<int>();
+            private readonly List<(IVariableSet set, int slot)> variables = new List<(IVariableSet, int)>();
+            private readonly List<Func<int>> globals = new List<Func<int>>();
+            private readonly List<CallSite> calls = new List<CallSite>();
+            private readonly List<string> errors = new List<string>();
+            private readonly Dictionary<(string set, string name), int> variableSlots = new Dictionary<(string, string), int>();
+            private readonly Dictionary<string, int> globalSlots = new Dictionary<string, int>();
+            private readonly Dictionary<int, int> constantSlots = new Dictionary<int, int>();
+            private int conditionDepth = 0;
+            private int maxConditionDepth = 0;
+
+            public BlockCompiler(Interpreter interpreter)
+            {
+                this.interpreter = interpreter;
+            }
+
+            public CompiledBlock Compile(InstructionBlockNode block)
+            {
+                Emit(block);
+                return new CompiledBlock
+                {
+                    ops = ops.ToArray(),
+                    constants = constants.ToArray(),
+                    variables = variables.ToArray(),
+                    globals = globals.ToArray(),
+                    calls = calls.ToArray(),
+                    errors = errors.ToArray(),
+                    maxConditionDepth = maxConditionDepth
+                };
+            }
+
+            private void Emit(InstructionBlockNode block)
+            {
+                foreach (var instruction in block.Instructions)
+                    Emit(instruction);
+            }
+
+            private void Emit(InstructionNode instruction)
+            {
+                switch (instruction)
+                {
+                    case AssignmentNode assignment:
+                        if (!TryResolveVariable(assignment.Target, out var target, out var error) ||
+                            !TryResolveValue(assignment.Value, out var value, out error))
+                            EmitThrow(error);
+                        else
+                            ops.Add(new Op(OpCode.Assign, target >> 2, value));
+                        break;
+                    case FunctionCallNode call:
+                        if (TryResolveCall(call, out var callSite, out error))
+                            ops.Add(new Op(OpCode.Call, callSite));
+                        else
+                            EmitThrow(error);
+                        break;
+                    case ReturnNode _:
+                        ops.Add(new Op(OpCode.Return));
+                        break;
+                    case IfNode @if:
+                        Emit(@if.Condition);
+                        int jumpToElse = ops.Count;
+                        ops.Add(default);
+                        conditionDepth--;
+                        Emit(@if.Then);
+                        if (@if.Else == null)
+                            ops[jumpToElse] = new Op(OpCode.JumpIfFalse, ops.Count);
+                        else
+                        {
+                            int jumpToEnd = ops.Count;
+                            ops.Add(default);
+                            ops[jumpToElse] = new Op(OpCode.JumpIfFalse, ops.Count);
+                            Emit(@if.Else);
+                            ops[jumpToEnd] = new Op(OpCode.Jump, ops.Count);
+                        }
+                        break;
+                    default: throw new InvalidProgramException("Unknown instruction node");
+                }
+            }
+
+            private void Emit(ConditionNode condition)
+            {
+                switch (condition)
+                {
+                    case LogicalNode logical:
+                        Emit(logical.Left);
+                        Emit(logical.Right);
+                        ops.Add(new Op(logical.Op switch
+                        {
+                            LogicalOp.And => OpCode.And,
+                            LogicalOp.Or => OpCode.Or,
+                            var _ => throw new InvalidProgramException("Unknown logical operator")
+                        }));
+                        conditionDepth--;
+                        break;
+                    case ComparisonNode comparison:
+                        if (!TryResolveValue(comparison.Left, out var left, out var error) ||
+                            !TryResolveValue(comparison.Right, out var right, out error))
+                            EmitThrow(error, pushedConditions: 1);
+                        else
+                        {
+                            ops.Add(new Op(comparison.Op switch
+                            {
+                                ComparisonOp.Equals => OpCode.Equals,
+                                ComparisonOp.NotEquals => OpCode.NotEquals,
+                                var _ => throw new InvalidProgramException("Unknown comparison operator")
+                            }, left, right));
+                        }
+                        conditionDepth++;
+                        maxConditionDepth = Math.Max(maxConditionDepth, conditionDepth);
+                        break;
+                    default: throw new InvalidProgramException("Unknown condition node");
+                }
+            }
+
+            /// <summary>Errors are only thrown once they are reached, just as when interpreting the nodes</summary>
+            private void EmitThrow(string error, int pushedConditions = 0)
+            {
+                ops.Add(new Op(OpCode.Throw, errors.Count, pushedConditions));
+                errors.Add(error);
+            }
+
+            private bool TryResolveValue(ValueNode valueNode, out int value, out string error)
+            {
+                error = "";
+                switch (valueNode)
+                {
+                    case NumericNode numeric:
+                        value = Slot(constantSlots, constants, (int)numeric.Value, (int)numeric.Value, ValueKind.Constant);
+                        return true;
+                    case VariableNode variable:
+                        return TryResolveVariable(variable, out value, out error);
+                    case StringNode stringNode:
+                        if (!interpreter.globalValues.TryGetValue(stringNode.Value, out var valueGetter))
+                        {
+                            value = 0;
+                            error = $"Unknown global value {stringNode.Value}";
+                            return false;
+                        }
+                        value = Slot(globalSlots, globals, stringNode.Value, valueGetter, ValueKind.Global);
+                        return true;
+                    case VectorNode _:
+                        value = 0;
+                        error = "Vectors cannot be evaluated";
+                        return false;
+                    default: throw new InvalidProgramException("Unknown value node");
+                }
+            }
+
+            private bool TryResolveVariable(VariableNode variable, out int value, out string error)
+            {
+                error = "";
+                if (!interpreter.variableSets.TryGetValue(variable.Set, out var variableSet))
+                {
+                    value = 0;
+                    error = $"Unknown variable set \"{variable.Set}\"";
+                    return false;
+                }
+                value = Slot(variableSlots, variables, (variable.Set, variable.Name), (variableSet, variableSet.GetSlot(variable.Name)), ValueKind.Variable);
+                return true;
+            }
+
+            private static int Slot<TKey, TValue>(Dictionary<TKey, int> slots, List<TValue> values, TKey key, TValue value, ValueKind kind) where TKey : notnull
+            {
+                if (!slots.TryGetValue(key, out var slot))
+                {
+                    slot = values.Count;
+                    values.Add(value);
+                    slots.Add(key, slot);
+                }
+                return (slot << 2) | (int)kind;
+            }
+
+            private bool TryResolveCall(FunctionCallNode call, out int callSite, out string error)
+            {
+                callSite = calls.Count;
+                error = "";
+                try
+                {
+                    calls.Add(interpreter.Bind(call));
+                    return true;
+                }
+                catch (InvalidDataException e)
+                {
+                    error = e.Message;
+                    return false;
+                }
+            }
+        }
+
+        private ConditionalWeakTable<InstructionBlockNode, CompiledBlock> compiledBlocks = new ConditionalWeakTable<InstructionBlockNode, CompiledBlock>();
+
+        private CompiledBlock Compile(InstructionBlockNode block) =>
+            compiledBlocks.GetValue(block, b => new BlockCompiler(this).Compile(b));
+
+        /// <summary>Compiled blocks and call sites reference the resolved slots, so they have to be recompiled after any registration</summary>
+        private void InvalidateCompiledBlocks()
+        {
+            compiledBlocks.Clear();
+            callSites.Clear();
+        }
+
+        private Task Execute(InstructionBlockNode block, CancellationToken? token = null) =>
+            ExecuteTiered(Compile(block), token ?? CancellationToken.None);
+
+        private async Task Execute(CompiledBlock block, CancellationToken token)
+        {
+            var ops = block.ops;
+            var conditions = block.maxConditionDepth == 0 ? Array.Empty<bool>() : new bool[block.maxConditionDepth];
+            int conditionDepth = 0;
+            for (int pc = 0; pc < ops.Length; pc++)
+            {
+                if (token.IsCancellationRequested)
+                    return;
+                var op = ops[pc];
+                switch (op.Code)
+                {
+                    case OpCode.Equals:
+                        conditions[conditionDepth++] = block.Load(op.A) == block.Load(op.B);
+                        break;
+                    case OpCode.NotEquals:
+                        conditions[conditionDepth++] = block.Load(op.A) != block.Load(op.B);
+                        break;
+                    case OpCode.And:
+                        conditionDepth--;
+                        conditions[conditionDepth - 1] = conditions[conditionDepth - 1] && conditions[conditionDepth];
+                        break;
+                    case OpCode.Or:
+                        conditionDepth--;
+                        conditions[conditionDepth - 1] = conditions[conditionDepth - 1] || conditions[conditionDepth];
+                        break;
+                    case OpCode.JumpIfFalse:
+                        if (!conditions[--conditionDepth])
+                            pc = op.A - 1;
+                        break;
+                    case OpCode.Jump:
+                        pc = op.A - 1;
+                        break;
+                    case OpCode.Assign:
+                        var (set, slot) = block.variables[op.A];
+                        set[slot] = block.Load(op.B);
+                        break;
+                    case OpCode.Call:
+                        var callSite = block.calls[op.A];
+                        var pending = callSite.map.Invoke(callSite.MapArguments());
+                        if (pending != null)
+                            await pending;
+                        break;
+                    case OpCode.Return:
+                        cts?.Cancel(); // like the tree walker, this only ends blocks running with the token of cts
+                        break;
+                    case OpCode.Throw:
+                        throw new InvalidDataException(block.errors[op.A]);
+                    default: throw new InvalidProgramException("Unknown op code");
+                }
+            }
+        }
+    }
+}
@@ -2,8 +2,10 @@
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
+using System.Linq.Expressions;
 using System.Numerics;
 using System.Reflection;
+using System.Runtime.CompilerServices;
 using System.Text.RegularExpressions;
 using System.Threading.Tasks;
 
@@ -20,6 +22,12 @@ namespace Aura.Script
         }
     }
 
+    /// <summary>Registers the script functions of a class without reflection, implemented by Aura.Generators for partial classes</summary>
+    public interface IScriptFunctionProvider
+    {
+        void RegisterScriptFunctions(Interpreter interpreter);
+    }
+
     public partial class Interpreter
     {
         private struct ArgumentMapping
@@ -27,6 +35,7 @@ namespace Aura.Script
             public Type csharp;
             public Type aura;
             public Func<ValueNode, object> mapper;
+            public bool isPure; // the result only depends on the node, so it can be mapped ahead of time
 
             public override string ToString() => $"C# {csharp.Name} <- Aura {aura.Name}";
         }
@@ -34,9 +43,31 @@ namespace Aura.Script
         private struct FunctionMapping
         {
             public object? thiz;
-            public MethodInfo method;
-            public ParameterInfo[] args;
+            public MethodInfo? method; // null for generated functions, which are only called through their invoker
+            public Type[] parameterTypes;
             public bool isAsync;
+            public Lazy<Func<object?[], Task?>> invoker; // shared between clones
+
+            /// <summary>Calls the function, returns the task of async functions and null otherwise</summary>
+            public Task? Invoke(object?[] arguments) => invoker.Value(arguments);
+        }
+
+        /// <summary>A function call with its function and argument mappings selected</summary>
+        private class CallSite
+        {
+            public FunctionMapping map;
+            public object?[] arguments = null!; // with all pure arguments mapped ahead of time
+            public (int index, ArgumentMapping mapping, ValueNode node)[] lateArguments = null!;
+
+            public object?[] MapArguments()
+            {
+                if (lateArguments.Length == 0)
+                    return arguments;
+                var result = (object?[])arguments.Clone();
+                foreach (var (index, mapping, node) in lateArguments)
+                    result[index] = mapping.mapper(node);
+                return result;
+            }
         }
 
         private static readonly IReadOnlyDictionary<string, CubeFace> CubeFaceNames = new Dictionary<string, CubeFace>()
@@ -49,50 +80,57 @@ namespace Aura.Script
             { "DOWNN", CubeFace.Down }
         };
 
-        private List<ArgumentMapping> argumentMappings = new List<ArgumentMapping>()
+        private Dictionary<(Type csharp, Type aura), ArgumentMapping> argumentMappings = new[]
         {
             new ArgumentMapping
             {
                 csharp = typeof(string),
                 aura = typeof(StringNode),
-                mapper = node => ((StringNode)node).Value
+                mapper = node => ((StringNode)node).Value,
+                isPure = true
             },
             new ArgumentMapping
             {
                 // just a path without prefix
                 csharp = typeof(string),
                 aura = typeof(VariableNode),
-                mapper = node => $"{((VariableNode)node).Set}.{((VariableNode)node).Name}"
+                mapper = node => $"{((VariableNode)node).Set}.{((VariableNode)node).Name}",
+                isPure = true
             },
             new ArgumentMapping
             {
                 csharp = typeof(int),
                 aura = typeof(NumericNode),
-                mapper = node => (int)((NumericNode)node).Value
+                mapper = node => (int)((NumericNode)node).Value,
+                isPure = true
             },
             new ArgumentMapping
             {
                 csharp = typeof(float),
                 aura = typeof(NumericNode),
-                mapper = node => (float)((NumericNode)node).Value
+                mapper = node => (float)((NumericNode)node).Value,
+                isPure = true
             },
             new ArgumentMapping
             {
                 csharp = typeof(double),
                 aura = typeof(NumericNode),
-                mapper = node => ((NumericNode)node).Value
+                mapper = node => ((NumericNode)node).Value,
+                isPure = true
             },
             new ArgumentMapping
             {
                 csharp = typeof(bool),
                 aura = typeof(NumericNode),
-                mapper = node => ((NumericNode)node).Value != 0
+                mapper = node => ((NumericNode)node).Value != 0,
+                isPure = true
             },
             new ArgumentMapping
             {
                 csharp = typeof(Vector2),
                 aura = typeof(VectorNode),
-                mapper = node => new Vector2(((VectorNode)node).X, ((VectorNode)node).Y)
+                mapper = node => new Vector2(((VectorNode)node).X, ((VectorNode)node).Y),
+                isPure = true
             },
             new ArgumentMapping
             {
@@ -104,16 +142,16 @@ namespace Aura.Script
                     if (!CubeFaceNames.TryGetValue(stringNode.Value, out var face))
                         throw new InvalidDataException($"{node.Position}: Unknown cube face name \"{stringNode.Value}\"");
                     return face;
-                }
+                },
+                isPure = true
             }
-        };
+        }.ToDictionary(m => (m.csharp, m.aura));
 
         private Dictionary<string, FunctionMapping> functionMappings = new Dictionary<string, FunctionMapping>();
 
         private bool FindArgumentMapping(Type csharp, Type aura, out ArgumentMapping mapping)
         {
-            mapping = argumentMappings.SingleOrDefault(m => m.csharp == csharp && m.aura == aura);
-            if (mapping.mapper == null)
+            if (!argumentMappings.TryGetValue((csharp, aura), out mapping))
             {
                 mapping = new ArgumentMapping
                 {
@@ -130,52 +168,148 @@ namespace Aura.Script
             var mapping = new ArgumentMapping { csharp = csharp, aura = aura, mapper = mapper };
             if (FindArgumentMapping(csharp, aura, out var _))
                 throw new InvalidProgramException($"There already exists an argument mapping for {mapping}");
-            argumentMappings.Add(mapping);
+            argumentMappings.Add((csharp, aura), mapping);
+            InvalidateCompiledBlocks();
         }
 
         private void RegisterFunction(string auraName, object? thiz, MethodInfo method)
         {
-            if (functionMappings.ContainsKey(auraName))
-                throw new InvalidProgramException($"There already exists a function mapping for {auraName}");
             bool isAsync = method.ReturnType != typeof(void);
             if (isAsync && !typeof(Task).IsAssignableFrom(method.ReturnType))
                 throw new ArgumentException("Method has to return either void or Task");
 
-            functionMappings.Add(auraName, new FunctionMapping
+            RegisterFunction(auraName, new FunctionMapping
             {
                 thiz = thiz,
                 method = method,
-                args = method.GetParameters(),
-                isAsync = isAsync
+                parameterTypes = method.GetParameters().Select(p => p.ParameterType).ToArray(),
+                isAsync = isAsync,
+                invoker = new Lazy<Func<object?[], Task?>>(() => CreateInvoker(thiz, method))
             });
         }
 
-        private async Task Execute(FunctionCallNode call)
+        /// <summary>Registers a function called through an invoker, the invoker returns the task of async functions and null otherwise</summary>
+        public void RegisterFunction(string auraName, Type[] parameterTypes, bool isAsync, Func<object?[], Task?> invoker) =>
+            RegisterFunction(auraName, new FunctionMapping
+            {
+                parameterTypes = parameterTypes,
+                isAsync = isAsync,
+                invoker = new Lazy<Func<object?[], Task?>>(invoker)
+            });
+
+        private void RegisterFunction(string auraName, FunctionMapping mapping)
+        {
+            if (functionMappings.ContainsKey(auraName))
+                throw new InvalidProgramException($"There already exists a function mapping for {auraName}");
+            functionMappings.Add(auraName, mapping);
+            InvalidateCompiledBlocks();
+        }
+
+        private FunctionMapping FindFunction(FunctionCallNode call)
         {
             if (!functionMappings.TryGetValue(call.Function, out var map))
                 throw new InvalidDataException($"Unknown function {call.Function}");
-            if (map.args.Length != call.Arguments.Count())
-                throw new InvalidDataException($"Unexpected parameter count, expected {map.args.Length}, got {call.Arguments.Count()}");
+            int argumentCount = call.Arguments.Count;
+            if (map.parameterTypes.Length != argumentCount)
+                throw new InvalidDataException($"Unexpected parameter count, expected {map.parameterTypes.Length}, got {argumentCount}");
+            return map;
+        }
 
-            var args = call.Arguments.Select((arg, i) =>
+        /// <summary>Compiles a delegate calling the method with unboxed arguments, null arguments are passed as default values</summary>
+        private static Func<object?[], Task?> CreateInvoker(object? thiz, MethodInfo method)
+        {
+            var arguments = Expression.Parameter(typeof(object?[]), "arguments");
+            var parameters = method.GetParameters().Select((param, i) =>
             {
-                var auraArg = call.Arguments.ElementAt(i);
+                var argument = Expression.ArrayIndex(arguments, Expression.Constant(i));
+                var converted = Expression.Convert(argument, param.ParameterType);
+                return param.ParameterType.IsValueType
+                    ? Expression.Condition(Expression.Equal(argument, Expression.Constant(null)), Expression.Default(param.ParameterType), converted)
+                    : (Expression)converted;
+            });
+            var instance = method.IsStatic ? null : Expression.Constant(thiz, method.DeclaringType!);
+            var call = Expression.Call(instance, method, parameters);
+            var body = method.ReturnType == typeof(void)
+                ? Expression.Block(call, Expression.Constant(null, typeof(Task)))
+                : (Expression)Expression.Convert(call, typeof(Task));
+            return Expression.Lambda<Func<object?[], Task?>>(body, arguments).Compile();
+        }
+
+        private ConditionalWeakTable<FunctionCallNode, CallSite> callSites = new ConditionalWeakTable<FunctionCallNode, CallSite>();
+
+        /// <summary>Selects the function and argument mappings of a call once, they are reused for every execution</summary>
+        private CallSite Bind(FunctionCallNode call) => callSites.GetValue(call, c =>
+        {
+            var map = FindFunction(c);
+            var arguments = c.Arguments.ToArray();
+            var mappedArguments = new object?[arguments.Length];
+            var lateArguments = new List<(int, ArgumentMapping, ValueNode)>();
+            for (int i = 0; i < arguments.Length; i++)
+            {
+                var auraArg = arguments[i];
                 if (auraArg == null)
-                    return null;
-                if (!FindArgumentMapping(map.args[i].ParameterType, auraArg.GetType(), out var argMap))
+                    continue;
+                if (!FindArgumentMapping(map.parameterTypes[i], auraArg.GetType(), out var argMap))
                     throw new InvalidDataException($"Unknown argument mapping {argMap}");
-                return argMap.mapper(auraArg);
-            }).ToArray();
+                if (!argMap.isPure || !TryMapAhead(argMap, auraArg, out mappedArguments[i]))
+                    lateArguments.Add((i, argMap, auraArg));
+            }
+            return new CallSite
+            {
+                map = map,
+                arguments = mappedArguments,
+                lateArguments = lateArguments.ToArray()
+            };
+        });
+
+        private static bool TryMapAhead(ArgumentMapping argMap, ValueNode auraArg, out object? mapped)
+        {
+            try
+            {
+                mapped = argMap.mapper(auraArg);
+                return true;
+            }
+            catch (InvalidDataException)
+            {
+                mapped = null; // e.g. unknown cube faces have to fail only once the call is reached
+                return false;
+            }
+        }
+
+        /// <summary>Maps the arguments of a call ahead of its execution, e.g. to load the referenced assets on another thread</summary>
+        public object?[] MapArguments(FunctionCallNode call) => (object?[])Bind(call).MapArguments().Clone();
+
+        /// <summary>Finds the arguments of a call which would be mapped to the given C# type</summary>
+        public IEnumerable<ValueNode> FindArgumentsOfType(FunctionCallNode call, Type csharp)
+        {
+            var map = FindFunction(call);
+            return call.Arguments
+                .Where((arg, i) => arg != null && map.parameterTypes[i] == csharp)
+                .Select(arg => arg!);
+        }
 
-            if (map.isAsync)
-                await (Task)map.method.Invoke(map.thiz, args)!;
-            else
-                map.method.Invoke(map.thiz, args);
+        private Task Execute(FunctionCallNode call)
+        {
+            var callSite = Bind(call);
+            return callSite.map.Invoke(callSite.MapArguments()) ?? Task.CompletedTask;
         }
 
+        private Task Execute(FunctionCallNode call, object?[] mappedArguments) =>
+            Bind(call).map.Invoke(mappedArguments) ?? Task.CompletedTask;
+
+        /// <summary>Converts an argument for generated invokers, null arguments are passed as default values</summary>
+        public static T Argument<T>(object? value) => value == null ? default! : (T)value;
+
         private static readonly Regex FunctionPrefix = new Regex(@"^Scr");
         public void RegisterAllFunctionsIn(object target)
         {
+            if (target is IScriptFunctionProvider provider)
+            {
+                provider.RegisterScriptFunctions(this);
+                return;
+            }
+
+            // reflection fallback for classes the generator could not handle
             var type = target.GetType();
             var methods = type.GetMethods(BindingFlags.Instance | BindingFlags.NonPublic | BindingFlags.Public);
             foreach (var method in methods)
@@ -0,0 +1,189 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Linq.Expressions;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace Aura.Script
+{
+    public partial class Interpreter
+    {
+        /// <summary>Number of executions after which a block is compiled to a delegate</summary>
+        public const int NativeTierThreshold = 8;
+
+        private const int NativeDonePC = -1;
+
+        /// <summary>Runs a block from <paramref name="pc"/> until it ends or reaches an async function, whose task is returned</summary>
+        private delegate Task? NativeBlock(ref int pc, CancellationToken token);
+
+        private Task ExecuteTiered(CompiledBlock block, CancellationToken token)
+        {
+            if (block.nativeTask == null)
+            {
+                if (!block.isNativeDisabled && ++block.executionCount >= NativeTierThreshold)
+                    block.nativeTask = Task.Run(() => new NativeCompiler(block, () => cts?.Cancel()).Compile());
+            }
+            else if (block.nativeTask.IsCompletedSuccessfully)
+                return Execute(block.nativeTask.Result, token);
+            else if (block.nativeTask.IsCompleted)
+            {
+                // the bytecode still runs the block, a failed optimization is not a script error
+                Console.Error.WriteLine($"Warning: Could not compile a script block natively: {block.nativeTask.Exception?.GetBaseException().Message}");
+                block.nativeTask = null;
+                block.isNativeDisabled = true;
+            }
+            return Execute(block, token);
+        }
+
+        private async Task Execute(NativeBlock block, CancellationToken token)
+        {
+            int pc = 0;
+            while (!token.IsCancellationRequested)
+            {
+                var pending = block(ref pc, token);
+                if (pending == null)
+                    return;
+                await pending;
+            }
+        }
+
+        /// <summary>Translates the bytecode of a block to an expression tree with the same control flow</summary>
+        private class NativeCompiler
+        {
+            private readonly CompiledBlock block;
+            private readonly Action cancelExecution;
+            private readonly ParameterExpression pc = Expression.Parameter(typeof(int).MakeByRefType(), "pc");
+            private readonly ParameterExpression token = Expression.Parameter(typeof(CancellationToken), "token");
+            private readonly LabelTarget returnLabel = Expression.Label(typeof(Task), "return");
+            private readonly LabelTarget[] opLabels;
+            private readonly ParameterExpression[] conditions;
+
+            public NativeCompiler(CompiledBlock block, Action cancelExecution)
+            {
+                this.block = block;
+                this.cancelExecution = cancelExecution;
+                opLabels = Enumerable.Range(0, block.ops.Length + 1).Select(i => Expression.Label($"op{i}")).ToArray();
+                conditions = Enumerable.Range(0, block.maxConditionDepth).Select(i => Expression.Variable(typeof(bool), $"condition{i}")).ToArray();
+            }
+
+            public NativeBlock Compile()
+            {
+                var resumeCases = new List<SwitchCase>();
+                var body = new List<Expression>();
+                int conditionDepth = 0;
+                for (int i = 0; i < block.ops.Length; i++)
+                {
+                    var op = block.ops[i];
+                    body.Add(Expression.Label(opLabels[i]));
+                    switch (op.Code)
+                    {
+                        case OpCode.Equals:
+                            body.Add(Expression.Assign(conditions[conditionDepth++], Expression.Equal(Load(op.A), Load(op.B))));
+                            break;
+                        case OpCode.NotEquals:
+                            body.Add(Expression.Assign(conditions[conditionDepth++], Expression.NotEqual(Load(op.A), Load(op.B))));
+                            break;
+                        case OpCode.And:
+                            conditionDepth--;
+                            body.Add(Expression.Assign(conditions[conditionDepth - 1], Expression.And(conditions[conditionDepth - 1], conditions[conditionDepth])));
+                            break;
+                        case OpCode.Or:
+                            conditionDepth--;
+                            body.Add(Expression.Assign(conditions[conditionDepth - 1], Expression.Or(conditions[conditionDepth - 1], conditions[conditionDepth])));
+                            break;
+                        case OpCode.JumpIfFalse:
+                            body.Add(Expression.IfThen(Expression.Not(conditions[--conditionDepth]), Expression.Goto(opLabels[op.A])));
+                            break;
+                        case OpCode.Jump:
+                            body.Add(Expression.Goto(opLabels[op.A]));
+                            break;
+                        case OpCode.Assign:
+                            var (set, slot) = block.variables[op.A];
+                            body.Add(Expression.Assign(Variable(set, slot), Load(op.B)));
+                            break;
+                        case OpCode.Call:
+                            var callSite = block.calls[op.A];
+                            var call = Call(callSite);
+                            if (callSite.map.isAsync)
+                            {
+                                body.Add(Expression.Assign(pc, Expression.Constant(i + 1)));
+                                body.Add(Expression.Return(returnLabel, Expression.Convert(call, typeof(Task))));
+                                resumeCases.Add(Expression.SwitchCase(Expression.Goto(opLabels[i + 1]), Expression.Constant(i + 1)));
+                            }
+                            else
+                            {
+                                body.Add(call);
+                                body.Add(ReturnIfCancelled()); // the called function might have cancelled the execution
+                            }
+                            break;
+                        case OpCode.Return:
+                            body.Add(Expression.Invoke(Expression.Constant(cancelExecution)));
+                            body.Add(ReturnIfCancelled());
+                            break;
+                        case OpCode.Throw:
+                            body.Add(Expression.Throw(Expression.New(
+                                typeof(InvalidDataException).GetConstructor(new[] { typeof(string) })!,
+                                Expression.Constant(block.errors[op.A]))));
+                            conditionDepth += op.B;
+                            break;
+                        default: throw new InvalidProgramException("Unknown op code");
+                    }
+                }
+                body.Add(Expression.Label(opLabels[block.ops.Length]));
+                body.Add(Expression.Assign(pc, Expression.Constant(NativeDonePC)));
+                body.Add(Expression.Label(returnLabel, Expression.Constant(null, typeof(Task))));
+
+                if (resumeCases.Any())
+                    body.Insert(0, Expression.Switch(pc, resumeCases.ToArray()));
+                var lambda = Expression.Lambda<NativeBlock>(Expression.Block(typeof(Task), conditions, body), pc, token);
+                return lambda.Compile();
+            }
+
+            private Expression ReturnIfCancelled() => Expression.IfThen(
+                Expression.Property(token, nameof(CancellationToken.IsCancellationRequested)),
+                Expression.Block(
+                    Expression.Assign(pc, Expression.Constant(NativeDonePC)),
+                    Expression.Return(returnLabel, Expression.Constant(null, typeof(Task)))));
+
+            private Expression Load(int value) => (ValueKind)(value & 3) switch
+            {
+                ValueKind.Constant => Expression.Constant(block.constants[value >> 2]),
+                ValueKind.Variable => Variable(block.variables[value >> 2].set, block.variables[value >> 2].slot),
+                ValueKind.Global => Expression.Invoke(Expression.Constant(block.globals[value >> 2])),
+                var _ => throw new InvalidProgramException("Unknown value kind")
+            };
+
+            private static Expression Variable(IVariableSet set, int slot) =>
+                Expression.Property(Expression.Constant(set, typeof(IVariableSet)), "Item", Expression.Constant(slot));
+
+            private static Expression Call(CallSite callSite)
+            {
+                var map = callSite.map;
+                if (map.method == null)
+                {
+                    // generated functions are already typed thunks, they take the precomputed arguments of the call site
+                    // like the bytecode does, only calls with late arguments copy the array to map them into
+                    return Expression.Invoke(
+                        Expression.Constant(map.invoker.Value),
+                        Expression.Call(Expression.Constant(callSite), typeof(CallSite).GetMethod(nameof(CallSite.MapArguments))!));
+                }
+
+                var arguments = map.parameterTypes.Select((parameterType, i) =>
+                {
+                    var lateArgument = callSite.lateArguments.FirstOrDefault(a => a.index == i);
+                    if (lateArgument.node != null)
+                        return Expression.Convert(Expression.Invoke(
+                            Expression.Constant(lateArgument.mapping.mapper),
+                            Expression.Constant(lateArgument.node, typeof(ValueNode))), parameterType);
+                    if (callSite.arguments[i] == null)
+                        return Expression.Default(parameterType);
+                    return (Expression)Expression.Convert(Expression.Constant(callSite.arguments[i]), parameterType);
+                });
+                var instance = map.method.IsStatic ? null : Expression.Constant(map.thiz, map.method.DeclaringType!);
+                return Expression.Call(instance, map.method, arguments);
+            }
+        }
+    }
+}
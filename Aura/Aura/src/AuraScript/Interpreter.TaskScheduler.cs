@@ -97,9 +97,11 @@ namespace Aura.Script
             }, cts.Token);
         }
 
-        public void ExecuteSync(FunctionCallNode callNode) => ExecuteSync(Execute, callNode);
+        public void ExecuteSync(FunctionCallNode callNode) => ExecuteSync((call, _) => Execute(call), callNode);
         public void ExecuteSync(InstructionBlockNode blockNode) => ExecuteSync(Execute, blockNode);
-        public Task ExecuteAsync(FunctionCallNode callNode, CancellationToken? token = null) => ExecuteAsync(Execute, callNode, token);
+        public void ExecuteSync(FunctionCallNode callNode, object?[] mappedArguments) =>
+            ExecuteSync((call, _) => Execute(call.node, call.arguments), (node: callNode, arguments: mappedArguments));
+        public Task ExecuteAsync(FunctionCallNode callNode, CancellationToken? token = null) => ExecuteAsync((call, _) => Execute(call), callNode, token);
         public Task ExecuteAsync(InstructionBlockNode blockNode, CancellationToken? token = null) => ExecuteAsync(Execute, blockNode, token);
     }
 }
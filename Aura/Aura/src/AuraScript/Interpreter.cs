@@ -9,7 +9,12 @@ namespace Aura.Script
 {
     public interface IVariableSet
     {
+        /// <summary>Accesses a variable by name, compiled scripts use slots instead</summary>
         int this[string name] { get; set; }
+
+        /// <summary>Resolves a variable name to a slot, accessing the slot throws if there is no such variable</summary>
+        int GetSlot(string name);
+        int this[int slot] { get; set; }
     }
     
     public partial class Interpreter
@@ -35,7 +40,7 @@ namespace Aura.Script
         {
             var clone = new Interpreter();
             clone.variableSets = variableSets.ToDictionary(p => p.Key, p => p.Value);
-            clone.argumentMappings = argumentMappings.ToList();
+            clone.argumentMappings = argumentMappings.ToDictionary(p => p.Key, p => p.Value);
             clone.functionMappings = functionMappings.ToDictionary(p => p.Key, p => p.Value);
             clone.globalValues = globalValues.ToDictionary(p => p.Key, p => p.Value);
             return clone;
@@ -46,6 +51,7 @@ namespace Aura.Script
             if (variableSets.ContainsKey(name))
                 throw new InvalidProgramException($"Variable set {name} is already registered");
             variableSets[name] = set;
+            InvalidateCompiledBlocks();
         }
 
         public void RegisterGlobalValue(string name, Func<int> valueGetter)
@@ -53,6 +59,7 @@ namespace Aura.Script
             if (globalValues.ContainsKey(name))
                 throw new InvalidOperationException($"Global value {name} is already registered");
             globalValues[name] = valueGetter;
+            InvalidateCompiledBlocks();
         }
 
         public bool Evaluate(ConditionNode condition)
@@ -110,50 +117,5 @@ namespace Aura.Script
                 throw new InvalidDataException($"Unknown global value {stringNode.Value}");
             return valueGetter();
         }
-
-        private async Task Execute(InstructionBlockNode block, CancellationToken? token = null)
-        {
-            token ??= CancellationToken.None;
-            foreach (var instruction in block.Instructions)
-            {
-                if (token.Value.IsCancellationRequested)
-                    return;
-                await Execute(instruction, token);
-            }
-        }
-
-        private Task Execute(InstructionNode instruction, CancellationToken? token = null) => instruction switch
-        {
-            _ when instruction is AssignmentNode => Execute((AssignmentNode)instruction),
-            _ when instruction is FunctionCallNode => Execute((FunctionCallNode)instruction),
-            _ when instruction is ReturnNode => Execute((ReturnNode)instruction),
-            _ when instruction is IfNode => Execute((IfNode)instruction, token),
-            var _ => throw new NotImplementedException("Unimplemented instruction node")
-        };
-
-        private Task Execute(AssignmentNode assignment)
-        {
-            if (!variableSets.TryGetValue(assignment.Target.Set, out var variableSet))
-                throw new InvalidDataException($"Unknown variable set {assignment.Target.Set}");
-            variableSet[assignment.Target.Name] = Evaluate(assignment.Value);
-            return Task.CompletedTask;
-        }
-
-        private Task Execute(ReturnNode _)
-        {
-            cts?.Cancel();
-            return Task.CompletedTask;
-        }
-        
-        private Task Execute(IfNode @if, CancellationToken? token = null)
-        { 
-            bool condition = Evaluate(@if.Condition);
-            if (condition)
-                return Execute(@if.Then, token);
-            else if (@if.Else != null)
-                return Execute(@if.Else, token);
-            else
-                return Task.CompletedTask;
-        }
     }
 }
@@ -3,171 +3,149 @@ using System.Collections.Generic;
 
 namespace Aura.Script
 {
+    /// <summary>View of a node stored in a syntax arena</summary>
     public abstract class Node
     {
-        public ScriptPos Position { get; }
+        private protected readonly SyntaxArena arena;
+        private protected readonly int index;
 
-        public Node(ScriptPos pos) { Position = pos; }
+        public ScriptPos Position => arena.Position(index);
+
+        private protected Node(SyntaxArena arena, int index)
+        {
+            this.arena = arena;
+            this.index = index;
+        }
+
+        /// <summary>The name or string value of the node</summary>
+        private protected string StringOperand => arena.String(arena.A(index));
+
+        private protected static string NameOf(SyntaxArena arena, int node) => arena.String(arena.A(node));
     }
 
     public class DefaultValueNode : Node
     {
-        public string Name { get; }
-        public ValueNode Value { get; }
+        public string Name => StringOperand;
+        public ValueNode Value => arena.View<ValueNode>(arena.B(index));
 
-        public DefaultValueNode(ScriptPos pos, string target, ValueNode value) : base(pos)
-        {
-            Name = target;
-            Value = value;
-        }
+        internal DefaultValueNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class SceneNode : Node
     {
-        public IReadOnlyDictionary<string, EntityListNode> EntityLists { get; }
-        public IReadOnlyDictionary<string, EventNode> Events { get; }
+        private IReadOnlyDictionary<string, EntityListNode>? entityLists;
+        private IReadOnlyDictionary<string, EventNode>? events;
 
-        public SceneNode(ScriptPos pos, IReadOnlyDictionary<string, EntityListNode> lists, IReadOnlyDictionary<string, EventNode> events) : base(pos)
-        {
-            EntityLists = lists;
-            Events = events;
-        }
+        public IReadOnlyDictionary<string, EntityListNode> EntityLists => entityLists ??=
+            new NodeDictionary<string, EntityListNode>(arena, arena.B(index), arena.C(index), NameOf);
+        public IReadOnlyDictionary<string, EventNode> Events => events ??=
+            new NodeDictionary<string, EventNode>(arena, arena.B(index) + arena.C(index), arena.A(index), NameOf);
+
+        internal SceneNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class EventNode : Node
     {
-        public string Name { get; }
-        public InstructionBlockNode Action { get; }
+        public string Name => StringOperand;
+        public InstructionBlockNode Action => arena.View<InstructionBlockNode>(arena.B(index));
 
-        public EventNode(ScriptPos pos, string name, InstructionBlockNode action) : base(pos)
-        {
-            Name = name;
-            Action = action;
-        }
+        internal EventNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public abstract class EntityListNode : Node
     {
-        public string Name { get; }
+        public string Name => StringOperand;
 
-        public EntityListNode(ScriptPos pos, string name) : base(pos)
-        {
-            Name = name;
-        }
+        private protected EntityListNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class GraphicListNode : EntityListNode
     {
-        public IReadOnlyDictionary<int, GraphicNode> Graphics { get; }
+        private IReadOnlyDictionary<int, GraphicNode>? graphics;
 
-        public GraphicListNode(ScriptPos pos, string name, IReadOnlyDictionary<int, GraphicNode> graphics) : base(pos, name)
-        {
-            Graphics = graphics;
-        }
+        public IReadOnlyDictionary<int, GraphicNode> Graphics => graphics ??=
+            new NodeDictionary<int, GraphicNode>(arena, arena.B(index), arena.C(index), (arena, node) => arena.A(node));
+
+        internal GraphicListNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class ObjectListNode : EntityListNode
     {
-        public IReadOnlyDictionary<string, ObjectNode> Objects { get; }
+        private IReadOnlyDictionary<string, ObjectNode>? objects;
 
-        public ObjectListNode(ScriptPos pos, string name, IReadOnlyDictionary<string, ObjectNode> cells) : base(pos, name)
-        {
-            Objects = cells;
-        }
+        public IReadOnlyDictionary<string, ObjectNode> Objects => objects ??=
+            new NodeDictionary<string, ObjectNode>(arena, arena.B(index), arena.C(index), NameOf);
+
+        internal ObjectListNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class GraphicNode : Node
     {
-        public int ID { get; }
-        public FunctionCallNode Value { get; }
+        public int ID => arena.A(index);
+        public FunctionCallNode Value => arena.View<FunctionCallNode>(arena.B(index));
 
-        public GraphicNode(ScriptPos pos, int id, FunctionCallNode value) : base(pos)
-        {
-            ID = id;
-            Value = value;
-        }
+        internal GraphicNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class ObjectNode : Node
     {
-        public string Name { get; }
-        public IReadOnlyDictionary<string, PropertyNode> Properties { get; }
+        private IReadOnlyDictionary<string, PropertyNode>? properties;
 
-        public ObjectNode(ScriptPos pos, string name, IReadOnlyDictionary<string, PropertyNode> props) : base(pos)
-        {
-            Name = name;
-            Properties = props;
-        }
+        public string Name => StringOperand;
+        public IReadOnlyDictionary<string, PropertyNode> Properties => properties ??=
+            new NodeDictionary<string, PropertyNode>(arena, arena.B(index), arena.C(index), NameOf);
+
+        internal ObjectNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class PropertyNode : Node
     {
-        public string Name { get; }
-        public ValueNode Value { get; }
+        public string Name => StringOperand;
+        public ValueNode Value => arena.View<ValueNode>(arena.B(index));
 
-        public PropertyNode(ScriptPos pos, string name, ValueNode value) : base(pos)
-        {
-            Name = name;
-            Value = value;
-        }
+        internal PropertyNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class InstructionBlockNode : Node
     {
-        public IEnumerable<InstructionNode> Instructions { get; }
+        public IEnumerable<InstructionNode> Instructions => new NodeList<InstructionNode>(arena, arena.B(index), arena.C(index));
 
-        public InstructionBlockNode(ScriptPos pos, IEnumerable<InstructionNode> instructions) : base(pos)
-        {
-            Instructions = instructions;
-        }
+        internal InstructionBlockNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public abstract class InstructionNode : Node
     {
-        public InstructionNode(ScriptPos pos) : base(pos) { }
+        private protected InstructionNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class ReturnNode : InstructionNode
     {
-        public ReturnNode(ScriptPos pos) : base(pos) { }
+        internal ReturnNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class AssignmentNode : InstructionNode
     {
-        public VariableNode Target { get; }
-        public ValueNode Value { get; }
+        public VariableNode Target => arena.View<VariableNode>(arena.A(index));
+        public ValueNode Value => arena.View<ValueNode>(arena.B(index));
 
-        public AssignmentNode(ScriptPos pos, VariableNode target, ValueNode value) : base(pos)
-        {
-            Target = target;
-            Value = value;
-        }
+        internal AssignmentNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class FunctionCallNode : InstructionNode
     {
-        public string Function { get; }
-        public IEnumerable<ValueNode?> Arguments { get; }
+        public string Function => StringOperand;
+        public IReadOnlyList<ValueNode?> Arguments => new NodeList<ValueNode?>(arena, arena.B(index), arena.C(index));
 
-        public FunctionCallNode(ScriptPos pos, string function, IEnumerable<ValueNode?> args) : base(pos)
-        {
-            Function = function;
-            Arguments = args;
-        }
+        internal FunctionCallNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class IfNode : InstructionNode
     {
-        public ConditionNode Condition { get; }
-        public InstructionBlockNode Then { get; }
-        public InstructionBlockNode? Else { get; }
+        public ConditionNode Condition => arena.View<ConditionNode>(arena.A(index));
+        public InstructionBlockNode Then => arena.View<InstructionBlockNode>(arena.B(index));
+        public InstructionBlockNode? Else => arena.OptionalView<InstructionBlockNode>(arena.C(index));
 
-        public IfNode(ScriptPos pos, ConditionNode condition, InstructionBlockNode thenBlock, InstructionBlockNode? elseBlock) : base(pos)
-        {
-            Condition = condition;
-            Then = thenBlock;
-            Else = elseBlock;
-        }
+        internal IfNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public enum ComparisonOp
@@ -184,83 +162,59 @@ namespace Aura.Script
 
     public abstract class ConditionNode : Node
     {
-        public ConditionNode(ScriptPos pos) : base(pos) { }
+        private protected ConditionNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class ComparisonNode : ConditionNode
     {
-        public ValueNode Left { get; }
-        public ValueNode Right { get; }
-        public ComparisonOp Op { get; }
+        public ValueNode Left => arena.View<ValueNode>(arena.A(index));
+        public ValueNode Right => arena.View<ValueNode>(arena.B(index));
+        public ComparisonOp Op => (ComparisonOp)arena.C(index);
 
-        public ComparisonNode(ScriptPos pos, ValueNode left, ValueNode right, ComparisonOp op) : base(pos)
-        {
-            Left = left;
-            Right = right;
-            Op = op;
-        }
+        internal ComparisonNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class LogicalNode : ConditionNode
     {
-        public ConditionNode Left { get; }
-        public ConditionNode Right { get; }
-        public LogicalOp Op { get; }
+        public ConditionNode Left => arena.View<ConditionNode>(arena.A(index));
+        public ConditionNode Right => arena.View<ConditionNode>(arena.B(index));
+        public LogicalOp Op => (LogicalOp)arena.C(index);
 
-        public LogicalNode(ScriptPos pos, ConditionNode left, ConditionNode right, LogicalOp op) : base(pos)
-        {
-            Left = left;
-            Right = right;
-            Op = op;
-        }
+        internal LogicalNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public abstract class ValueNode : Node
     {
-        public ValueNode(ScriptPos pos) : base(pos) { }
+        private protected ValueNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class VariableNode : ValueNode
     {
-        public string Set { get; }
-        public string Name { get; }
+        public string Set => StringOperand;
+        public string Name => arena.String(arena.B(index));
 
-        public VariableNode(ScriptPos pos, string set, string name) : base(pos)
-        {
-            Set = set;
-            Name = name;
-        }
+        internal VariableNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class NumericNode : ValueNode
     {
-        public double Value { get; }
+        public double Value => arena.Number(index);
 
-        public NumericNode(ScriptPos pos, double value) : base(pos)
-        {
-            Value = value;
-        }
+        internal NumericNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class VectorNode : ValueNode
     {
-        public int X { get; }
-        public int Y { get; }
+        public int X => arena.A(index);
+        public int Y => arena.B(index);
 
-        public VectorNode(ScriptPos pos, int x, int y) : base(pos)
-        {
-            X = x;
-            Y = y;
-        }
+        internal VectorNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 
     public class StringNode : ValueNode
     {
-        public string Value { get; }
+        public string Value => StringOperand;
 
-        public StringNode(ScriptPos pos, string value) : base(pos)
-        {
-            Value = value;
-        }
+        internal StringNode(SyntaxArena arena, int index) : base(arena, index) { }
     }
 }
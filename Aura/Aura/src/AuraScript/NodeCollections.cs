@@ -0,0 +1,108 @@
+﻿using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Diagnostics.CodeAnalysis;
+using System.Linq;
+
+namespace Aura.Script
+{
+    /// <summary>List view of a child range of a syntax arena, missing children are null</summary>
+    internal sealed class NodeList<T> : IReadOnlyList<T> where T : Node?
+    {
+        private readonly SyntaxArena arena;
+        private readonly int first;
+
+        public int Count { get; }
+
+        public NodeList(SyntaxArena arena, int first, int count)
+        {
+            this.arena = arena;
+            this.first = first;
+            Count = count;
+        }
+
+        public T this[int index]
+        {
+            get
+            {
+                if ((uint)index >= (uint)Count)
+                    throw new ArgumentOutOfRangeException(nameof(index));
+                int node = arena.Child(first + index);
+                return node < 0 ? default! : (T)arena.View(node);
+            }
+        }
+
+        public IEnumerator<T> GetEnumerator()
+        {
+            for (int i = 0; i < Count; i++)
+                yield return this[i];
+        }
+
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+    }
+
+    /// <summary>Dictionary view of a child range of a syntax arena, the parser already rejected duplicate keys</summary>
+    internal sealed class NodeDictionary<TKey, TNode> : IReadOnlyDictionary<TKey, TNode> where TKey : notnull where TNode : Node
+    {
+        private const int MaxLinearCount = 8; // small lists are searched without hashing
+
+        private readonly SyntaxArena arena;
+        private readonly int first;
+        private readonly Func<SyntaxArena, int, TKey> keyOf;
+        private Dictionary<TKey, int>? index;
+
+        public int Count { get; }
+        public IEnumerable<TKey> Keys => Nodes().Select(node => keyOf(arena, node));
+        public IEnumerable<TNode> Values => Nodes().Select(node => arena.View<TNode>(node));
+
+        public NodeDictionary(SyntaxArena arena, int first, int count, Func<SyntaxArena, int, TKey> keyOf)
+        {
+            this.arena = arena;
+            this.first = first;
+            this.keyOf = keyOf;
+            Count = count;
+        }
+
+        public TNode this[TKey key] => TryGetValue(key, out var value)
+            ? value
+            : throw new KeyNotFoundException($"Could not find node {key}");
+
+        public bool ContainsKey(TKey key) => TryFindNode(key, out _);
+
+        public bool TryGetValue(TKey key, [MaybeNullWhen(false)] out TNode value)
+        {
+            bool found = TryFindNode(key, out var node);
+            value = found ? arena.View<TNode>(node) : null;
+            return found;
+        }
+
+        private bool TryFindNode(TKey key, out int node)
+        {
+            if (Count <= MaxLinearCount)
+            {
+                for (int i = 0; i < Count; i++)
+                {
+                    node = arena.Child(first + i);
+                    if (EqualityComparer<TKey>.Default.Equals(keyOf(arena, node), key))
+                        return true;
+                }
+                node = -1;
+                return false;
+            }
+            index ??= Nodes().ToDictionary(n => keyOf(arena, n));
+            return index.TryGetValue(key, out node);
+        }
+
+        private IEnumerable<int> Nodes()
+        {
+            for (int i = 0; i < Count; i++)
+                yield return arena.Child(first + i);
+        }
+
+        public IEnumerator<KeyValuePair<TKey, TNode>> GetEnumerator() => Nodes()
+            .Select(node => new KeyValuePair<TKey, TNode>(keyOf(arena, node), arena.View<TNode>(node)))
+            .GetEnumerator();
+
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+    }
+}
@@ -4,20 +4,20 @@ namespace Aura.Script
 {
     public class ObjectListParser : Parser
     {
-        public ObjectListParser(Tokenizer tokenizer) : base(tokenizer) {}
+        public ObjectListParser(Tokenizer tokenizer, SyntaxArena? arena = null, SyntaxCache? cache = null) : base(tokenizer, arena, cache) {}
 
         public new IEnumerable<ObjectNode> ParseObjectList()
         {
-            var objects = new List<ObjectNode>();
-            while(true)
+            int list = ParseRoot(() =>
             {
-                var token = Expect(TokenType.Identifier, TokenType.EndOfSource);
-                if (token.Type == TokenType.EndOfSource)
-                    return objects;
-
-                PushBack(token);
-                objects.Add(ParseObject());
-            }
+                var firstToken = Peek();
+                int mark = BeginChildren();
+                while (PeekExpected(TokenType.Identifier, TokenType.EndOfSource).Type != TokenType.EndOfSource)
+                    PushChild(ParseObject());
+                var (first, count) = EndChildren(mark);
+                return AddNode(NodeKind.List, firstToken, 0, first, count);
+            });
+            return new NodeList<ObjectNode>(Arena, Arena.B(list), Arena.C(list));
         }
     }
 }
@@ -1,110 +1,255 @@
 ﻿using System;
 using System.Collections.Generic;
-using System.Diagnostics.CodeAnalysis;
+using System.Globalization;
 using System.Linq;
-using System.Text.RegularExpressions;
 
 namespace Aura.Script
 {
+    /// <summary>Parses scripts into a syntax arena, the parse methods return the indices of the added nodes</summary>
     public abstract class Parser
     {
-        Tokenizer.TokenizerEnumerator scanner;
-        Stack<Token> backStack = new Stack<Token>();
-
-        protected Parser(Tokenizer tokenizer)
+        /// <summary>Has to be increased whenever the same source is parsed into different nodes, it invalidates the syntax caches</summary>
+        public const int Version = 1;
+
+        private const int LookaheadSize = 4; // a power of two, the parsers look at most three tokens ahead
+        private const int MaxLinearDuplicateCheck = 8;
+
+        private readonly Tokenizer.TokenizerEnumerator scanner;
+        private readonly IdentifierTable identifiers;
+        private readonly Token[] lookahead = new Token[LookaheadSize];
+        private int lookaheadStart;
+        private int lookaheadCount;
+        private readonly List<int> childStack = new List<int>();
+        private readonly int file;
+        private readonly bool ownsArena;
+        private readonly Tokenizer tokenizer;
+        private readonly SyntaxCache? cache;
+
+        protected SyntaxArena Arena { get; }
+
+        protected Parser(Tokenizer tokenizer, SyntaxArena? arena = null, SyntaxCache? cache = null)
         {
+            this.tokenizer = tokenizer;
+            this.cache = cache;
             scanner = tokenizer.GetEnumerator();
+            identifiers = tokenizer.Identifiers;
+            ownsArena = arena == null;
+            Arena = arena ?? new SyntaxArena();
+            file = Arena.AddFile(tokenizer.File, scanner.LineStarts);
+        }
+
+        /// <summary>Parses the whole source with <paramref name="parse"/> unless the cache already has its nodes</summary>
+        /// <returns>The root node of the source</returns>
+        protected int ParseRoot(Func<int> parse)
+        {
+            var key = cache == null ? default : SyntaxCache.KeyOf(tokenizer.SourceBytes, GetType().Name);
+            if (cache == null || !cache.TryLoad(key, Arena, file, scanner.LineStarts, identifiers, out var root))
+            {
+                int firstNode = Arena.Count;
+                int firstChild = Arena.ChildCount;
+                root = parse();
+                cache?.Store(key, Arena.ExportSegment(firstNode, firstChild, scanner.LineStarts, root));
+            }
+            if (ownsArena)
+                Arena.Trim(); // otherwise the arena is shared with other parsers
+            return root;
         }
 
-        protected void PushBack(params Token[] tokens)
+        protected Token Peek(int distance = 0)
         {
-            foreach (var token in tokens)
-                backStack.Push(token);
+            if (distance >= LookaheadSize)
+                throw new InvalidProgramException("Parser looked too far ahead");
+            while (lookaheadCount <= distance)
+            {
+                scanner.MoveNext();
+                lookahead[(lookaheadStart + lookaheadCount++) & (LookaheadSize - 1)] = scanner.Current;
+            }
+            return lookahead[(lookaheadStart + distance) & (LookaheadSize - 1)];
         }
 
         protected Token Next()
         {
-            if (backStack.Any())
-                return backStack.Pop();
-            scanner.MoveNext();
-            return scanner.Current;
+            var token = Peek();
+            lookaheadStart = (lookaheadStart + 1) & (LookaheadSize - 1);
+            lookaheadCount--;
+            return token;
+        }
+
+        protected void SkipToNextLine()
+        {
+            if (lookaheadCount > 0)
+                throw new InvalidProgramException("Cannot skip a line with tokens already looked at");
+            scanner.SkipToNextLine();
         }
 
-        protected Token Peek()
+        protected Token PeekExpected(int distance, TokenType type1, TokenType type2, TokenType type3)
         {
-            var token = Next();
-            backStack.Push(token);
+            var token = Peek(distance);
+            if (token.Type != type1 && token.Type != type2 && token.Type != type3)
+                throw new Exception($"{token.Pos}: Unexpected {token.Type}, expected one of {string.Join(", ", new[] { type1, type2, type3 }.Distinct())}");
             return token;
         }
 
-        protected Token? ContinueWith(params TokenType[] types)
+        protected Token PeekExpected(TokenType type) => PeekExpected(0, type, type, type);
+        protected Token PeekExpected(TokenType type1, TokenType type2) => PeekExpected(0, type1, type2, type2);
+        protected Token PeekExpected(TokenType type1, TokenType type2, TokenType type3) => PeekExpected(0, type1, type2, type3);
+
+        protected Token Expect(TokenType type)
+        {
+            PeekExpected(type);
+            return Next();
+        }
+
+        protected Token Expect(TokenType type1, TokenType type2)
         {
-            if (types.Contains(Peek().Type))
-                return Next();
-            return null;
+            PeekExpected(type1, type2);
+            return Next();
         }
 
-        protected Token Expect(params TokenType[] types)
+        protected Token Expect(TokenType type1, TokenType type2, TokenType type3)
         {
-            var token = ContinueWith(types);
-            if (!token.HasValue)
-                throw new Exception($"{Peek().Pos}: Unexpected {Peek().Type}, expected one of {string.Join(", ", types)}");
-            return token.Value;
+            PeekExpected(type1, type2, type3);
+            return Next();
         }
 
-        protected ScriptPos CalcPos(Token first, Token? next = null) => CalcPos(first.Pos, next?.Pos);
-        protected ScriptPos CalcPos(ScriptPos first, ScriptPos? next = null) => (next ?? Peek().Pos) - first;
+        protected Token? ContinueWith(TokenType type) => Peek().Type == type ? Next() : (Token?)null;
+
+        private protected int AddNode(NodeKind kind, Token first, int a = 0, int b = 0, int c = 0) =>
+            AddNode(kind, first.Pos.Character, Peek().Pos.Character, a, b, c);
 
-        protected IEnumerable<T> ParseBlockList<T>(TokenType firstToken, Func<T> parse)
+        private protected int AddNode(NodeKind kind, int start, int end, int a = 0, int b = 0, int c = 0) =>
+            Arena.Add(kind, file, start, end - start, a, b, c);
+
+        protected static int ToInteger(Token number)
         {
-            Expect(TokenType.BlockBracketOpen);
-            var list = new List<T>();
-            while (true)
-            {
-                var token = Expect(firstToken, TokenType.BlockBracketClose);
-                if (token.Type == TokenType.BlockBracketClose)
-                    return list;
+            int value = (int)number.Number;
+            if (value != number.Number)
+                throw new Exception($"{number.Pos}: Expected an integer");
+            return value;
+        }
+
+        /// <summary>Starts a list of child nodes, which are pushed by <see cref="PushChild"/></summary>
+        protected int BeginChildren() => childStack.Count;
 
-                PushBack(token);
-                list.Add(parse());
+        protected void PushChild(int node) => childStack.Add(node);
+
+        protected int ChildCount(int mark) => childStack.Count - mark;
+
+        /// <summary>Moves the children pushed since <paramref name="mark"/> into the arena</summary>
+        /// <returns>The first child and the number of children</returns>
+        protected (int first, int count) EndChildren(int mark)
+        {
+            int count = childStack.Count - mark;
+            return (Arena.AddChildren(childStack, mark), count);
+        }
+
+        /// <summary>Rejects duplicate keys among the children pushed since <paramref name="mark"/></summary>
+        /// <remarks>The key is the first operand, names are compared by their string index as the tokenizer interns them</remarks>
+        protected void CheckUniqueChildren(int mark, string what, bool isNamed = true)
+        {
+            int count = childStack.Count - mark;
+            var keys = count > MaxLinearDuplicateCheck ? new HashSet<int>() : null;
+            for (int i = mark; i < childStack.Count; i++)
+            {
+                int key = Arena.A(childStack[i]);
+                bool isDuplicate = false;
+                if (keys != null)
+                    isDuplicate = !keys.Add(key);
+                else
+                {
+                    for (int j = mark; j < i && !isDuplicate; j++)
+                        isDuplicate = Arena.A(childStack[j]) == key;
+                }
+                if (isDuplicate)
+                    throw new Exception($"{Arena.Position(childStack[i])}: Duplicate {what} \"{(isNamed ? Arena.String(key) : key.ToString())}\"");
             }
         }
 
-        private static readonly Regex VariableRegex = new Regex(@"^(\w+)\.(\w+)$");
-        protected bool TryParseVariable(Token identifier, [MaybeNullWhen(false)] out VariableNode variable)
+        /// <summary>Starts a list in block brackets</summary>
+        protected int BeginBlockList()
+        {
+            Expect(TokenType.BlockBracketOpen);
+            return BeginChildren();
+        }
+
+        /// <summary>Checks whether another element follows in a block list, consumes the closing bracket otherwise</summary>
+        protected bool ContinueBlockList(TokenType firstToken)
+        {
+            if (PeekExpected(firstToken, TokenType.BlockBracketClose).Type == firstToken)
+                return true;
+            Next();
+            return false;
+        }
+
+        protected bool TryParseVariable(Token identifier, out int variable)
         {
-            variable = null;
-            var match = VariableRegex.Match(identifier.Value);
-            if (!match.Success)
+            variable = -1;
+            var value = identifier.Value;
+            int dot = value.IndexOf('.');
+            if (dot < 0 || !IsWord(value.AsSpan(0, dot)) || !IsWord(value.AsSpan(dot + 1)))
                 return false;
-            variable = new VariableNode(CalcPos(identifier), match.Groups[1].Value, match.Groups[2].Value);
+            var set = identifiers.Intern(value.AsSpan(0, dot));
+            var name = identifiers.Intern(value.AsSpan(dot + 1));
+            variable = AddNode(NodeKind.Variable, identifier, Arena.AddString(set), Arena.AddString(name));
             return true;
         }
 
-        protected VectorNode ParseVector()
+        /// <summary>Whether the text is not empty and only contains regex word characters</summary>
+        private static bool IsWord(ReadOnlySpan<char> text)
+        {
+            if (text.IsEmpty)
+                return false;
+            foreach (var ch in text)
+            {
+                if (ch < 128)
+                {
+                    if (!char.IsLetterOrDigit(ch) && ch != '_')
+                        return false;
+                    continue;
+                }
+                switch (CharUnicodeInfo.GetUnicodeCategory(ch))
+                {
+                    case UnicodeCategory.UppercaseLetter:
+                    case UnicodeCategory.LowercaseLetter:
+                    case UnicodeCategory.TitlecaseLetter:
+                    case UnicodeCategory.ModifierLetter:
+                    case UnicodeCategory.OtherLetter:
+                    case UnicodeCategory.NonSpacingMark:
+                    case UnicodeCategory.DecimalDigitNumber:
+                    case UnicodeCategory.ConnectorPunctuation:
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        protected int ParseVector()
         {
             var bracketOpen = Expect(TokenType.TupleBracketOpen);
             var x = Expect(TokenType.Number);
             Expect(TokenType.Comma);
             var y = Expect(TokenType.Number);
             Expect(TokenType.TupleBracketClose);
-            return new VectorNode(CalcPos(bracketOpen), int.Parse(x.Value), int.Parse(y.Value));
+            return AddNode(NodeKind.Vector, bracketOpen, ToInteger(x), ToInteger(y));
         }
 
-        protected ValueNode ParseValue()
+        protected int ParseValue()
         {
-            var token = Expect(TokenType.Identifier, TokenType.Number, TokenType.TupleBracketOpen);
+            var token = PeekExpected(TokenType.Identifier, TokenType.Number, TokenType.TupleBracketOpen);
+            if (token.Type == TokenType.TupleBracketOpen)
+                return ParseVector();
+            Next();
             if (token.Type == TokenType.Number)
-                return new NumericNode(CalcPos(token), double.Parse(token.Value));
-            else if (token.Type == TokenType.TupleBracketOpen)
             {
-                PushBack(token);
-                return ParseVector();
+                long bits = BitConverter.DoubleToInt64Bits(token.Number);
+                return AddNode(NodeKind.Numeric, token, (int)bits, (int)(bits >> 32));
             }
             else if (TryParseVariable(token, out var variable))
                 return variable;
             else
-                return new StringNode(CalcPos(token), token.Value);
+                return AddNode(NodeKind.String, token, Arena.AddString(token.Value));
         }
 
         protected ComparisonOp ParseComparisonOp()
@@ -113,25 +258,26 @@ namespace Aura.Script
             return token.Type == TokenType.Equals ? ComparisonOp.Equals : ComparisonOp.NotEquals;
         }
 
-        protected ComparisonNode ParseComparison()
+        protected int ParseComparison()
         {
             var bracketOpen = Expect(TokenType.ExprBracketOpen);
             var left = ParseValue();
             var op = ParseComparisonOp();
             var right = ParseValue();
             var bracketClose = Expect(TokenType.ExprBracketClose);
-            return new ComparisonNode(CalcPos(bracketOpen, bracketClose), left, right, op);
+            return AddNode(NodeKind.Comparison, bracketOpen.Pos.Character, bracketClose.Pos.Character, left, right, (int)op);
         }
 
         protected LogicalOp? OptParseLogicalOp()
         {
-            var token = ContinueWith(TokenType.LogicalAnd, TokenType.LogicalOr);
-            if (token == null)
+            var type = Peek().Type;
+            if (type != TokenType.LogicalAnd && type != TokenType.LogicalOr)
                 return null;
-            return token.Value.Type == TokenType.LogicalAnd ? LogicalOp.And : LogicalOp.Or;
+            Next();
+            return type == TokenType.LogicalAnd ? LogicalOp.And : LogicalOp.Or;
         }
 
-        protected ConditionNode ParseLogical()
+        protected int ParseLogical()
         {
             var bracketOpen = Expect(TokenType.ExprBracketOpen);
             var left = ParseCondition();
@@ -142,66 +288,64 @@ namespace Aura.Script
                 return left;
             }
             var right = ParseCondition();
-            var logical = new LogicalNode(CalcPos(bracketOpen), left, right, op.Value);
+            var logical = AddNode(NodeKind.Logical, bracketOpen, left, right, (int)op.Value);
 
-            while(true)
+            while (true)
             {
                 var token = Expect(TokenType.LogicalAnd, TokenType.LogicalOr, TokenType.ExprBracketClose);
                 if (token.Type == TokenType.ExprBracketClose)
                     return logical;
 
-                PushBack(token);
-                op = OptParseLogicalOp();
-                if (op == null)
-                    throw new Exception($"{token.Pos}: Expected logical operator");
+                op = token.Type == TokenType.LogicalAnd ? LogicalOp.And : LogicalOp.Or;
                 right = ParseCondition();
-                logical = new LogicalNode(CalcPos(bracketOpen), logical, right, op.Value);
+                logical = AddNode(NodeKind.Logical, bracketOpen, logical, right, (int)op.Value);
             }
         }
 
-        protected ConditionNode ParseCondition()
+        protected int ParseCondition()
         {
-            var bracket = Expect(TokenType.ExprBracketOpen);
-            var token = Peek();
-            PushBack(bracket);
-
-            if (token.Type == TokenType.ExprBracketOpen)
+            PeekExpected(TokenType.ExprBracketOpen);
+            if (Peek(1).Type == TokenType.ExprBracketOpen)
                 return ParseLogical();
             else
                 return ParseComparison();
         }
 
-        protected FunctionCallNode ParseFunctionCall()
+        protected int ParseFunctionCall()
         {
             var function = Expect(TokenType.Identifier);
             Expect(TokenType.ExprBracketOpen);
-            var args = new List<ValueNode?>();
-            while(true)
+            int mark = BeginChildren();
+            while (true)
             {
-                var token = Next();
+                var token = Peek();
                 if (token.Type == TokenType.ExprBracketClose)
                 {
-                    if (args.Count > 0) // for (constant, constant , )
-                        args.Add(null);
+                    Next();
+                    if (ChildCount(mark) > 0) // for (constant, constant , )
+                        PushChild(-1);
                     break;
                 }
                 else if (token.Type == TokenType.Comma)
-                    args.Add(null);
+                {
+                    Next();
+                    PushChild(-1);
+                }
                 else
                 {
-                    PushBack(token);
-                    args.Add(ParseValue());
-                    
+                    PushChild(ParseValue());
+
                     token = Expect(TokenType.Comma, TokenType.ExprBracketClose);
                     if (token.Type == TokenType.ExprBracketClose)
                         break;
                 }
             }
             Expect(TokenType.Semicolon);
-            return new FunctionCallNode(CalcPos(function), function.Value, args);
+            var (first, count) = EndChildren(mark);
+            return AddNode(NodeKind.FunctionCall, function, Arena.AddString(function.Value), first, count);
         }
 
-        protected AssignmentNode ParseAssignment()
+        protected int ParseAssignment()
         {
             var variableIdentifier = Expect(TokenType.Identifier);
             if (!TryParseVariable(variableIdentifier, out var variable))
@@ -209,10 +353,10 @@ namespace Aura.Script
             Expect(TokenType.Assign);
             var value = ParseValue();
             Expect(TokenType.Semicolon);
-            return new AssignmentNode(CalcPos(variableIdentifier), variable, value);
+            return AddNode(NodeKind.Assignment, variableIdentifier, variable, value);
         }
 
-        protected AssignmentNode ParseSetAssignment()
+        protected int ParseSetAssignment()
         {
             var setIdentifier = Expect(TokenType.Identifier);
             Expect(TokenType.TupleBracketOpen);
@@ -221,42 +365,39 @@ namespace Aura.Script
             Expect(TokenType.Assign);
             var value = ParseValue();
             Expect(TokenType.Semicolon);
-            var variable = new VariableNode(CalcPos(setIdentifier.Pos, value.Position), setIdentifier.Value, variableIdentifier.Value);
-            return new AssignmentNode(CalcPos(setIdentifier), variable, value);
+            var variable = AddNode(NodeKind.Variable, setIdentifier.Pos.Character, Arena.Offset(value),
+                Arena.AddString(setIdentifier.Value), Arena.AddString(variableIdentifier.Value));
+            return AddNode(NodeKind.Assignment, setIdentifier, variable, value);
         }
 
-        protected IfNode ParseIf()
+        protected int ParseIf()
         {
             var ifKeyword = Expect(TokenType.Identifier);
             var condition = ParseCondition();
-            scanner.SkipToNextLine(); // DAMN YOU Aura and your inconsistency D:<
+            SkipToNextLine(); // DAMN YOU Aura and your inconsistency D:<
             var thenBlock = ParseInstructionBlock();
 
-            var elseToken = ContinueWith(TokenType.Identifier);
-            if (!elseToken.HasValue)
-                return new IfNode(CalcPos(ifKeyword), condition, thenBlock, null);
-            else if (elseToken.Value.Value != "else")
+            var elseToken = Peek();
+            int elseBlock = -1;
+            if (elseToken.Type == TokenType.Identifier && elseToken.Value == "else")
             {
-                PushBack(elseToken.Value);
-                return new IfNode(CalcPos(ifKeyword), condition, thenBlock, null);
+                Next();
+                elseBlock = ParseInstructionBlock();
             }
-
-            var elseBlock = ParseInstructionBlock();
-            return new IfNode(CalcPos(ifKeyword), condition, thenBlock, elseBlock);
+            return AddNode(NodeKind.If, ifKeyword, condition, thenBlock, elseBlock);
         }
 
-        protected ReturnNode ParseReturn()
+        protected int ParseReturn()
         {
             var returnKeyword = Expect(TokenType.Identifier);
             Expect(TokenType.Semicolon);
-            return new ReturnNode(CalcPos(returnKeyword));
+            return AddNode(NodeKind.Return, returnKeyword);
         }
 
-        protected InstructionNode ParseInstruction()
+        protected int ParseInstruction()
         {
-            var token = Expect(TokenType.Identifier);
-            var next = Peek();
-            PushBack(token);
+            var token = PeekExpected(TokenType.Identifier);
+            var next = Peek(1);
 
             if (token.Value == "if")
                 return ParseIf();
@@ -272,35 +413,46 @@ namespace Aura.Script
                 throw new Exception($"{next.Pos}: Unexpected {next.Type}, expected one of ExprBracketOpen, Assign");
         }
 
-        protected InstructionBlockNode ParseInstructionBlock()
+        protected int ParseInstructionBlock()
         {
             var bracketOpen = Peek();
-            var list = ParseBlockList(TokenType.Identifier, ParseInstruction);
-            return new InstructionBlockNode(CalcPos(bracketOpen), list);
+            int mark = BeginBlockList();
+            while (ContinueBlockList(TokenType.Identifier))
+                PushChild(ParseInstruction());
+            var (first, count) = EndChildren(mark);
+            return AddNode(NodeKind.InstructionBlock, bracketOpen, 0, first, count);
         }
 
-        protected PropertyNode ParseProperty()
+        protected int ParseProperty()
         {
             var name = Expect(TokenType.Identifier);
             Expect(TokenType.Assign);
             var value = ParseValue();
             Expect(TokenType.Semicolon);
-            return new PropertyNode(CalcPos(name), name.Value, value);
+            return AddNode(NodeKind.Property, name, Arena.AddString(name.Value), value);
         }
 
-        protected ObjectNode ParseObject()
+        protected int ParseObject()
         {
             var name = Expect(TokenType.Identifier);
             ContinueWith(TokenType.Colon); // it is optional in Predmets.prd
-            var properties = ParseBlockList(TokenType.Identifier, ParseProperty);
-            return new ObjectNode(CalcPos(name), name.Value, properties.ToDictionary(p => p.Name, p => p));
+            int mark = BeginBlockList();
+            while (ContinueBlockList(TokenType.Identifier))
+                PushChild(ParseProperty());
+            CheckUniqueChildren(mark, "property");
+            var (first, count) = EndChildren(mark);
+            return AddNode(NodeKind.Object, name, Arena.AddString(name.Value), first, count);
         }
 
-        protected ObjectListNode ParseObjectList()
+        protected int ParseObjectList()
         {
             var name = Expect(TokenType.Identifier);
-            var cells = ParseBlockList(TokenType.Identifier, ParseObject);
-            return new ObjectListNode(CalcPos(name), name.Value, cells.ToDictionary(c => c.Name, c => c));
+            int mark = BeginBlockList();
+            while (ContinueBlockList(TokenType.Identifier))
+                PushChild(ParseObject());
+            CheckUniqueChildren(mark, "object");
+            var (first, count) = EndChildren(mark);
+            return AddNode(NodeKind.ObjectList, name, Arena.AddString(name.Value), first, count);
         }
     }
 }
@@ -1,68 +1,77 @@
 ﻿using System;
 using System.Collections.Generic;
-using System.Linq;
 
 namespace Aura.Script
 {
     public class SceneScriptParser : Parser
     {
-        public SceneScriptParser(Tokenizer tokenizer) : base(tokenizer) { }
+        public SceneScriptParser(Tokenizer tokenizer, SyntaxArena? arena = null, SyntaxCache? cache = null) : base(tokenizer, arena, cache) { }
 
-        private GraphicNode ParseGraphic()
+        private int ParseGraphic()
         {
             var id = Expect(TokenType.Number);
             Expect(TokenType.Assign);
-            return new GraphicNode(CalcPos(id), int.Parse(id.Value), ParseFunctionCall());
+            int end = Peek().Pos.Character;
+            return AddNode(NodeKind.Graphic, id.Pos.Character, end, ToInteger(id), ParseFunctionCall());
         }
 
-        private GraphicListNode ParseGraphicList()
+        private int ParseGraphicList()
         {
             var name = Expect(TokenType.Identifier);
-            var graphics = ParseBlockList(TokenType.Number, ParseGraphic);
-            return new GraphicListNode(CalcPos(name), name.Value, graphics.ToDictionary(g => g.ID, g => g));
+            int mark = BeginBlockList();
+            while (ContinueBlockList(TokenType.Number))
+                PushChild(ParseGraphic());
+            CheckUniqueChildren(mark, "graphic", isNamed: false);
+            var (first, count) = EndChildren(mark);
+            return AddNode(NodeKind.GraphicList, name, Arena.AddString(name.Value), first, count);
         }
 
-        private EntityListNode ParseEntityList()
+        private int ParseEntityList()
         {
-            var name = Expect(TokenType.Identifier);
-            var bracket = Expect(TokenType.BlockBracketOpen);
-            var key = Expect(TokenType.Identifier, TokenType.Number, TokenType.BlockBracketClose);
-            PushBack(key, bracket, name);
+            PeekExpected(1, TokenType.BlockBracketOpen, TokenType.BlockBracketOpen, TokenType.BlockBracketOpen);
+            var key = PeekExpected(2, TokenType.Identifier, TokenType.Number, TokenType.BlockBracketClose);
             if (key.Type == TokenType.Identifier)
                 return ParseObjectList();
             else // treat empty entity lists as graphic lists, empty cell lists will be too rare to care about
                 return ParseGraphicList();
         }
 
-        private EventNode ParseEvent()
+        private int ParseEvent()
         {
             var name = Expect(TokenType.Identifier);
             var action = ParseInstructionBlock();
-            return new EventNode(CalcPos(name), name.Value, action);
+            return AddNode(NodeKind.Event, name, Arena.AddString(name.Value), action);
         }
 
-        public SceneNode ParseSceneScript()
+        public SceneNode ParseSceneScript() => Arena.View<SceneNode>(ParseRoot(ParseScene));
+
+        private int ParseScene()
         {
-            var entityLists = new List<EntityListNode>();
-            var events = new List<EventNode>();
+            var events = new List<int>();
             var firstToken = Peek();
+            int mark = BeginChildren();
             while (true)
             {
-                var token = Expect(TokenType.Identifier, TokenType.EndOfSource);
+                var token = PeekExpected(TokenType.Identifier, TokenType.EndOfSource);
                 if (token.Type == TokenType.EndOfSource)
-                    return new SceneNode(
-                        CalcPos(firstToken),
-                        entityLists.ToDictionary(l => l.Name, l => l),
-                        events.ToDictionary(l => l.Name, l => l));
+                    break;
 
-                PushBack(token); // the name
                 if (token.Value.StartsWith("&"))
-                    entityLists.Add(ParseEntityList());
+                    PushChild(ParseEntityList());
                 else if (token.Value.StartsWith("@"))
                     events.Add(ParseEvent());
                 else
                     throw new Exception($"{token.Pos}: Unexpected identifier, expected either an event or an entity list");
             }
+
+            CheckUniqueChildren(mark, "entity list");
+            var (first, entityListCount) = EndChildren(mark);
+            mark = BeginChildren();
+            foreach (var @event in events)
+                PushChild(@event);
+            CheckUniqueChildren(mark, "event");
+            EndChildren(mark); // directly after the entity lists
+            return AddNode(NodeKind.Scene, firstToken, events.Count, first, entityListCount);
         }
     }
 }
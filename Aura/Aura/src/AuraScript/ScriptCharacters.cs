@@ -0,0 +1,82 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+
+namespace Aura.Script
+{
+    [Flags]
+    internal enum CharacterClass : byte
+    {
+        None = 0,
+        Space = 1 << 0,
+        CommentStart = 1 << 1,
+        IdentifierStart = 1 << 2,
+        IdentifierPart = 1 << 3,
+        NumberStart = 1 << 4,
+        NumberPart = 1 << 5,
+        StringPart = 1 << 6
+    }
+
+    /// <summary>Classifies the characters of script texts by lookup tables instead of per-character checks</summary>
+    internal static class ScriptCharacters
+    {
+        private static readonly CharacterClass[] classes = new CharacterClass[256];
+        private static readonly TokenType?[] singleCharTokens = new TokenType?[128];
+
+        static ScriptCharacters()
+        {
+            for (int ch = 0; ch < classes.Length; ch++)
+                classes[ch] = Compute((char)ch);
+            singleCharTokens['{'] = TokenType.BlockBracketOpen;
+            singleCharTokens['}'] = TokenType.BlockBracketClose;
+            singleCharTokens['('] = TokenType.ExprBracketOpen;
+            singleCharTokens[')'] = TokenType.ExprBracketClose;
+            singleCharTokens['['] = TokenType.TupleBracketOpen;
+            singleCharTokens[']'] = TokenType.TupleBracketClose;
+            singleCharTokens[';'] = TokenType.Semicolon;
+            singleCharTokens[':'] = TokenType.Colon;
+            singleCharTokens[','] = TokenType.Comma;
+        }
+
+        private static CharacterClass Compute(char ch)
+        {
+            var result = CharacterClass.None;
+            if (char.IsWhiteSpace(ch))
+                result |= CharacterClass.Space;
+            if (ch == '*' || ch == '/' || ch == '?')
+                result |= CharacterClass.CommentStart;
+            if (char.IsLetter(ch) || "_.\\$@&%".Contains(ch))
+                result |= CharacterClass.IdentifierStart;
+            if (char.IsLetterOrDigit(ch) || "_.\\".Contains(ch))
+                result |= CharacterClass.IdentifierPart;
+            if (char.IsDigit(ch) || ch == '-')
+                result |= CharacterClass.NumberStart;
+            if (char.IsDigit(ch) || ch == '.')
+                result |= CharacterClass.NumberPart;
+            if (ch >= 128 || (!char.IsControl(ch) && ch != '\"'))
+                result |= CharacterClass.StringPart;
+            return result;
+        }
+
+        public static CharacterClass Classify(int ch) => ch < classes.Length
+            ? classes[ch]
+            : Compute((char)ch);
+
+        public static bool Is(int ch, CharacterClass @class) => (Classify(ch) & @class) != 0;
+
+        public static TokenType? SingleCharToken(int ch) => ch < singleCharTokens.Length
+            ? singleCharTokens[ch]
+            : null;
+
+        /// <summary>Reads a character of either a text or ASCII bytes, which are read as '?' outside of ASCII just like the decoded script texts</summary>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static int At<TChar>(ReadOnlySpan<TChar> text, int index) where TChar : unmanaged
+        {
+            if (typeof(TChar) == typeof(byte))
+            {
+                byte ch = Unsafe.As<TChar, byte>(ref Unsafe.AsRef(in text[index]));
+                return ch < 128 ? ch : '?';
+            }
+            return Unsafe.As<TChar, char>(ref Unsafe.AsRef(in text[index]));
+        }
+    }
+}
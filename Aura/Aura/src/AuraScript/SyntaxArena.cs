@@ -0,0 +1,447 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace Aura.Script
+{
+    internal enum NodeKind : byte
+    {
+        List,           // b: first child, c: child count, the root of object and default value list files
+        DefaultValue,   // a: name, b: value
+        Scene,          // a: event count, b: first child, c: entity list count, the events follow the entity lists
+        Event,          // a: name, b: action
+        GraphicList,    // a: name, b: first child, c: child count
+        ObjectList,     // a: name, b: first child, c: child count
+        Graphic,        // a: id, b: function call
+        Object,         // a: name, b: first child, c: child count
+        Property,       // a: name, b: value
+        InstructionBlock, // b: first child, c: child count
+        Return,
+        Assignment,     // a: target, b: value
+        FunctionCall,   // a: function, b: first child, c: child count, missing arguments are -1
+        If,             // a: condition, b: then, c: else or -1
+        Comparison,     // a: left, b: right, c: operator
+        Logical,        // a: left, b: right, c: operator
+        Variable,       // a: set, b: name
+        Numeric,        // a, b: the bits of the number
+        Vector,         // a: x, b: y
+        String          // a: value
+    }
+
+    /// <summary>What an operand of a node refers to, used to relocate nodes between arenas</summary>
+    internal enum Operand : byte
+    {
+        Value,
+        Count,          // the number of children
+        Node,
+        OptionalNode,   // a node or -1
+        Child,          // the first child
+        String
+    }
+
+    /// <summary>Stores parsed script nodes as flat columns, the node classes are only created as views on access</summary>
+    /// <remarks>Names are indices into the string table, children are ranges in the child table and positions are file index and offset</remarks>
+    public class SyntaxArena
+    {
+        private const int InitialCapacity = 256;
+
+        private NodeKind[] kinds = new NodeKind[InitialCapacity];
+        private ushort[] files = new ushort[InitialCapacity];
+        private int[] offsets = new int[InitialCapacity];
+        private int[] lengths = new int[InitialCapacity];
+        private int[] a = new int[InitialCapacity];
+        private int[] b = new int[InitialCapacity];
+        private int[] c = new int[InitialCapacity];
+        private int count;
+        private int[] children = new int[InitialCapacity];
+        private int childCount;
+        private readonly List<string> strings = new List<string>();
+        private Dictionary<string, int>? stringIndices; // the strings are interned by the tokenizer, so they are compared by reference
+        private readonly List<(string name, List<int> lineStarts)> fileTable = new List<(string, List<int>)>();
+        private readonly object viewsLock = new object();
+        private Node?[] views = Array.Empty<Node?>();
+
+        public int Count => count;
+        internal int ChildCount => childCount;
+
+        /// <summary>Approximate memory held by the arena and its views</summary>
+        public long MemorySize =>
+            (long)kinds.Length * (sizeof(NodeKind) + sizeof(ushort) + 5 * sizeof(int)) +
+            children.Length * sizeof(int) +
+            strings.Count * IntPtr.Size +
+            views.Length * IntPtr.Size;
+
+        internal int AddFile(string name, List<int> lineStarts)
+        {
+            if (fileTable.Count > ushort.MaxValue)
+                throw new InvalidOperationException("Too many files in a syntax arena");
+            fileTable.Add((name, lineStarts));
+            return fileTable.Count - 1;
+        }
+
+        private void EnsureCapacity(int nodeCapacity, int childCapacity)
+        {
+            if (nodeCapacity > kinds.Length)
+            {
+                int capacity = Math.Max(Math.Max(InitialCapacity, kinds.Length * 2), nodeCapacity);
+                Array.Resize(ref kinds, capacity);
+                Array.Resize(ref files, capacity);
+                Array.Resize(ref offsets, capacity);
+                Array.Resize(ref lengths, capacity);
+                Array.Resize(ref a, capacity);
+                Array.Resize(ref b, capacity);
+                Array.Resize(ref c, capacity);
+            }
+            if (childCapacity > children.Length)
+                Array.Resize(ref children, Math.Max(children.Length * 2, childCapacity));
+        }
+
+        internal int Add(NodeKind kind, int file, int offset, int length, int a = 0, int b = 0, int c = 0)
+        {
+            EnsureCapacity(count + 1, 0);
+            kinds[count] = kind;
+            files[count] = (ushort)file;
+            offsets[count] = offset;
+            lengths[count] = length;
+            this.a[count] = a;
+            this.b[count] = b;
+            this.c[count] = c;
+            return count++;
+        }
+
+        internal int AddString(string value)
+        {
+            if (stringIndices == null)
+            {
+                stringIndices = new Dictionary<string, int>(strings.Count, ReferenceEqualityComparer.Instance);
+                for (int i = 0; i < strings.Count; i++)
+                    stringIndices[strings[i]] = i;
+            }
+            if (!stringIndices.TryGetValue(value, out var index))
+            {
+                index = strings.Count;
+                strings.Add(value);
+                stringIndices.Add(value, index);
+            }
+            return index;
+        }
+
+        /// <summary>Moves the nodes from <paramref name="start"/> to the end of <paramref name="stack"/> into the child table</summary>
+        /// <returns>The index of the first child</returns>
+        internal int AddChildren(List<int> stack, int start)
+        {
+            int added = stack.Count - start;
+            EnsureCapacity(0, childCount + added);
+            stack.CopyTo(start, children, childCount, added);
+            stack.RemoveRange(start, added);
+            childCount += added;
+            return childCount - added;
+        }
+
+        /// <summary>Releases the unused capacity once all scripts of the arena are parsed</summary>
+        public void Trim()
+        {
+            Array.Resize(ref kinds, count);
+            Array.Resize(ref files, count);
+            Array.Resize(ref offsets, count);
+            Array.Resize(ref lengths, count);
+            Array.Resize(ref a, count);
+            Array.Resize(ref b, count);
+            Array.Resize(ref c, count);
+            Array.Resize(ref children, childCount);
+            strings.TrimExcess();
+            stringIndices = null; // only needed while parsing
+            foreach (var (_, lineStarts) in fileTable)
+                lineStarts.TrimExcess();
+        }
+
+        private static (Operand a, Operand b, Operand c) Layout(NodeKind kind) => kind switch
+        {
+            NodeKind.List => (Operand.Value, Operand.Child, Operand.Count),
+            NodeKind.DefaultValue => (Operand.String, Operand.Node, Operand.Value),
+            NodeKind.Scene => (Operand.Count, Operand.Child, Operand.Count),
+            NodeKind.Event => (Operand.String, Operand.Node, Operand.Value),
+            NodeKind.GraphicList => (Operand.String, Operand.Child, Operand.Count),
+            NodeKind.ObjectList => (Operand.String, Operand.Child, Operand.Count),
+            NodeKind.Graphic => (Operand.Value, Operand.Node, Operand.Value),
+            NodeKind.Object => (Operand.String, Operand.Child, Operand.Count),
+            NodeKind.Property => (Operand.String, Operand.Node, Operand.Value),
+            NodeKind.InstructionBlock => (Operand.Value, Operand.Child, Operand.Count),
+            NodeKind.Return => (Operand.Value, Operand.Value, Operand.Value),
+            NodeKind.Assignment => (Operand.Node, Operand.Node, Operand.Value),
+            NodeKind.FunctionCall => (Operand.String, Operand.Child, Operand.Count),
+            NodeKind.If => (Operand.Node, Operand.Node, Operand.OptionalNode),
+            NodeKind.Comparison => (Operand.Node, Operand.Node, Operand.Value),
+            NodeKind.Logical => (Operand.Node, Operand.Node, Operand.Value),
+            NodeKind.Variable => (Operand.String, Operand.String, Operand.Value),
+            NodeKind.Numeric => (Operand.Value, Operand.Value, Operand.Value),
+            NodeKind.Vector => (Operand.Value, Operand.Value, Operand.Value),
+            NodeKind.String => (Operand.String, Operand.Value, Operand.Value),
+            var _ => throw new InvalidProgramException("Unknown node kind")
+        };
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        private struct SegmentHeader
+        {
+            public int nodeCount;
+            public int childCount;
+            public int lineCount;
+            public int stringCount;
+            public int stringLength;
+            public int root;
+        }
+
+        /// <summary>Serializes the nodes of one parse, which are all nodes and children added since <paramref name="firstNode"/> and <paramref name="firstChild"/></summary>
+        /// <remarks>Node and child references are stored relative to the segment and strings in a segment string table, so it can be imported into any arena</remarks>
+        internal byte[] ExportSegment(int firstNode, int firstChild, List<int> lineStarts, int root)
+        {
+            int nodeCount = count - firstNode;
+            int segmentChildCount = childCount - firstChild;
+            var stringMap = new Dictionary<int, int>();
+            var segmentStrings = new List<string>();
+            int Relocate(Operand operand, int value)
+            {
+                switch (operand)
+                {
+                    case Operand.Node:
+                    case Operand.OptionalNode:
+                        return value < 0 ? value : value - firstNode;
+                    case Operand.Child:
+                        return value - firstChild;
+                    case Operand.String:
+                        if (!stringMap.TryGetValue(value, out var segmentString))
+                        {
+                            segmentString = segmentStrings.Count;
+                            segmentStrings.Add(strings[value]);
+                            stringMap.Add(value, segmentString);
+                        }
+                        return segmentString;
+                    default: return value;
+                }
+            }
+
+            var operands = new int[3 * nodeCount];
+            for (int i = 0; i < nodeCount; i++)
+            {
+                int node = firstNode + i;
+                var (layoutA, layoutB, layoutC) = Layout(kinds[node]);
+                operands[i] = Relocate(layoutA, a[node]);
+                operands[nodeCount + i] = Relocate(layoutB, b[node]);
+                operands[2 * nodeCount + i] = Relocate(layoutC, c[node]);
+            }
+            var segmentChildren = new int[segmentChildCount];
+            for (int i = 0; i < segmentChildCount; i++)
+                segmentChildren[i] = Relocate(Operand.OptionalNode, children[firstChild + i]);
+            var stringLengths = segmentStrings.Select(s => s.Length).ToArray();
+
+            var header = new SegmentHeader
+            {
+                nodeCount = nodeCount,
+                childCount = segmentChildCount,
+                lineCount = lineStarts.Count,
+                stringCount = segmentStrings.Count,
+                stringLength = stringLengths.Sum(),
+                root = root - firstNode
+            };
+            var stream = new MemoryStream();
+            stream.Write(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref header, 1)));
+            stream.Write(MemoryMarshal.AsBytes(offsets.AsSpan(firstNode, nodeCount)));
+            stream.Write(MemoryMarshal.AsBytes(lengths.AsSpan(firstNode, nodeCount)));
+            stream.Write(MemoryMarshal.AsBytes(operands.AsSpan()));
+            stream.Write(MemoryMarshal.AsBytes(segmentChildren.AsSpan()));
+            stream.Write(MemoryMarshal.AsBytes(CollectionsMarshal.AsSpan(lineStarts)));
+            stream.Write(MemoryMarshal.AsBytes(stringLengths.AsSpan()));
+            foreach (var segmentString in segmentStrings)
+                stream.Write(MemoryMarshal.AsBytes(segmentString.AsSpan()));
+            stream.Write(MemoryMarshal.AsBytes(kinds.AsSpan(firstNode, nodeCount)));
+            return stream.ToArray();
+        }
+
+        /// <summary>Appends the nodes of a segment written by <see cref="ExportSegment"/> as nodes of <paramref name="file"/></summary>
+        /// <returns>False if the segment is malformed, the arena is left unchanged in that case</returns>
+        internal bool TryImportSegment(ReadOnlySpan<byte> segment, int file, List<int> lineStarts, IdentifierTable identifiers, out int root)
+        {
+            root = -1;
+            int headerSize = Unsafe.SizeOf<SegmentHeader>();
+            if (segment.Length < headerSize)
+                return false;
+            var header = MemoryMarshal.Read<SegmentHeader>(segment);
+            int nodeCount = header.nodeCount;
+            int segmentChildCount = header.childCount;
+            if (nodeCount <= 0 || segmentChildCount < 0 || header.lineCount <= 0 || header.stringCount < 0 || header.stringLength < 0 ||
+                header.root < 0 || header.root >= nodeCount ||
+                segment.Length != headerSize +
+                    (5L * nodeCount + segmentChildCount + header.lineCount + header.stringCount) * sizeof(int) +
+                    (long)header.stringLength * sizeof(char) +
+                    nodeCount * sizeof(NodeKind))
+                return false;
+
+            var ints = MemoryMarshal.Cast<byte, int>(segment.Slice(headerSize, (5 * nodeCount + segmentChildCount + header.lineCount + header.stringCount) * sizeof(int)));
+            var segmentOffsets = ints.Slice(0, nodeCount);
+            var segmentLengths = ints.Slice(nodeCount, nodeCount);
+            var operands = ints.Slice(2 * nodeCount, 3 * nodeCount);
+            var segmentChildren = ints.Slice(5 * nodeCount, segmentChildCount);
+            var segmentLineStarts = ints.Slice(5 * nodeCount + segmentChildCount, header.lineCount);
+            var stringLengths = ints.Slice(5 * nodeCount + segmentChildCount + header.lineCount);
+            var chars = MemoryMarshal.Cast<byte, char>(segment.Slice(headerSize + ints.Length * sizeof(int), header.stringLength * sizeof(char)));
+            var segmentKinds = MemoryMarshal.Cast<byte, NodeKind>(segment.Slice(segment.Length - nodeCount));
+
+            // validate everything first, so a damaged segment cannot leave dangling references behind
+            if (segmentLineStarts[0] != 0)
+                return false;
+            for (int i = 1; i < segmentLineStarts.Length; i++)
+            {
+                if (segmentLineStarts[i] <= segmentLineStarts[i - 1])
+                    return false;
+            }
+            long totalLength = 0;
+            foreach (var length in stringLengths)
+            {
+                if (length < 0)
+                    return false;
+                totalLength += length;
+            }
+            if (totalLength != header.stringLength)
+                return false;
+            foreach (var child in segmentChildren)
+            {
+                if (child < -1 || child >= nodeCount)
+                    return false;
+            }
+            for (int i = 0; i < nodeCount; i++)
+            {
+                if (segmentKinds[i] > NodeKind.String || segmentOffsets[i] < 0 || segmentLengths[i] < 0)
+                    return false;
+                var (layoutA, layoutB, layoutC) = Layout(segmentKinds[i]);
+                int operandA = operands[i], operandB = operands[nodeCount + i], operandC = operands[2 * nodeCount + i];
+                if (!IsValid(layoutA, operandA, i) || !IsValid(layoutB, operandB, i) || !IsValid(layoutC, operandC, i))
+                    return false;
+                if (layoutB == Operand.Child)
+                {
+                    long childEnd = (long)operandB + (layoutA == Operand.Count ? operandA : 0) + (layoutC == Operand.Count ? operandC : 0);
+                    if (operandB < 0 || childEnd > segmentChildCount)
+                        return false;
+                }
+            }
+            bool IsValid(Operand operand, int value, int node) => operand switch
+            {
+                Operand.Node => value >= 0 && value < node, // children are always added before their parent
+                Operand.OptionalNode => value >= -1 && value < node,
+                Operand.String => value >= 0 && value < header.stringCount,
+                Operand.Count => value >= 0,
+                var _ => true
+            };
+
+            var stringMap = new int[header.stringCount];
+            int stringOffset = 0;
+            for (int i = 0; i < stringMap.Length; i++)
+            {
+                stringMap[i] = AddString(identifiers.Intern(chars.Slice(stringOffset, stringLengths[i])));
+                stringOffset += stringLengths[i];
+            }
+            int firstNode = count;
+            int firstChild = childCount;
+            int Relocate(Operand operand, int value) => operand switch
+            {
+                Operand.Node => value + firstNode,
+                Operand.OptionalNode => value < 0 ? value : value + firstNode,
+                Operand.Child => value + firstChild,
+                Operand.String => stringMap[value],
+                var _ => value
+            };
+
+            EnsureCapacity(count + nodeCount, childCount + segmentChildCount);
+            segmentKinds.CopyTo(kinds.AsSpan(firstNode));
+            files.AsSpan(firstNode, nodeCount).Fill((ushort)file);
+            segmentOffsets.CopyTo(offsets.AsSpan(firstNode));
+            segmentLengths.CopyTo(lengths.AsSpan(firstNode));
+            for (int i = 0; i < nodeCount; i++)
+            {
+                var (layoutA, layoutB, layoutC) = Layout(segmentKinds[i]);
+                a[firstNode + i] = Relocate(layoutA, operands[i]);
+                b[firstNode + i] = Relocate(layoutB, operands[nodeCount + i]);
+                c[firstNode + i] = Relocate(layoutC, operands[2 * nodeCount + i]);
+            }
+            for (int i = 0; i < segmentChildCount; i++)
+                children[firstChild + i] = Relocate(Operand.OptionalNode, segmentChildren[i]);
+            count += nodeCount;
+            childCount += segmentChildCount;
+
+            lineStarts.Clear();
+            lineStarts.Capacity = Math.Max(lineStarts.Capacity, segmentLineStarts.Length);
+            foreach (var lineStart in segmentLineStarts)
+                lineStarts.Add(lineStart);
+            root = firstNode + header.root;
+            return true;
+        }
+
+        internal NodeKind Kind(int node) => kinds[node];
+        internal int Offset(int node) => offsets[node];
+        internal int A(int node) => a[node];
+        internal int B(int node) => b[node];
+        internal int C(int node) => c[node];
+        internal int Child(int child) => children[child];
+        internal string String(int stringIndex) => strings[stringIndex];
+        internal double Number(int node) => BitConverter.Int64BitsToDouble(((long)b[node] << 32) | (uint)a[node]);
+
+        internal ScriptPos Position(int node)
+        {
+            var (name, lineStarts) = fileTable[files[node]];
+            int offset = offsets[node];
+            int line = lineStarts.BinarySearch(offset);
+            if (line < 0)
+                line = ~line - 1;
+            return new ScriptPos(name, offset, line, offset - lineStarts[line], lengths[node]);
+        }
+
+        /// <summary>Returns the view of a node, every node has a single view so they can be used as keys</summary>
+        internal Node View(int node)
+        {
+            var current = Volatile.Read(ref views);
+            if (node < current.Length && current[node] != null)
+                return current[node]!;
+            lock (viewsLock)
+            {
+                if (node >= views.Length)
+                {
+                    var grown = new Node?[Math.Max(count, views.Length * 2)];
+                    Array.Copy(views, grown, views.Length);
+                    Volatile.Write(ref views, grown);
+                }
+                return views[node] ??= CreateView(node);
+            }
+        }
+
+        internal T View<T>(int node) where T : Node => (T)View(node);
+
+        internal T? OptionalView<T>(int node) where T : Node => node < 0 ? null : (T)View(node);
+
+        private Node CreateView(int node) => kinds[node] switch
+        {
+            NodeKind.DefaultValue => new DefaultValueNode(this, node),
+            NodeKind.Scene => new SceneNode(this, node),
+            NodeKind.Event => new EventNode(this, node),
+            NodeKind.GraphicList => new GraphicListNode(this, node),
+            NodeKind.ObjectList => new ObjectListNode(this, node),
+            NodeKind.Graphic => new GraphicNode(this, node),
+            NodeKind.Object => new ObjectNode(this, node),
+            NodeKind.Property => new PropertyNode(this, node),
+            NodeKind.InstructionBlock => new InstructionBlockNode(this, node),
+            NodeKind.Return => new ReturnNode(this, node),
+            NodeKind.Assignment => new AssignmentNode(this, node),
+            NodeKind.FunctionCall => new FunctionCallNode(this, node),
+            NodeKind.If => new IfNode(this, node),
+            NodeKind.Comparison => new ComparisonNode(this, node),
+            NodeKind.Logical => new LogicalNode(this, node),
+            NodeKind.Variable => new VariableNode(this, node),
+            NodeKind.Numeric => new NumericNode(this, node),
+            NodeKind.Vector => new VectorNode(this, node),
+            NodeKind.String => new StringNode(this, node),
+            var _ => throw new InvalidProgramException("Unknown node kind")
+        };
+    }
+}
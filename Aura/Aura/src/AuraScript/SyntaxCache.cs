@@ -0,0 +1,182 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+namespace Aura.Script
+{
+    /// <summary>A file of serialized syntax trees, e.g. of all scripts of a scene, so they do not have to be parsed again</summary>
+    /// <remarks>
+    /// A tree is keyed by a hash of its source text and the parser, the file is only valid for the
+    /// same <see cref="Parser.Version"/>. Trees which were not requested since the file was opened are
+    /// dropped when it is saved. Failing to read or write the cache is never fatal, the scripts are
+    /// parsed instead. The cache is not thread-safe.
+    /// </remarks>
+    public class SyntaxCache
+    {
+        private const uint Magic = 0x54534141; // AAST
+        private const uint Version = 1;
+        private const ulong HashPrime = 0x9E3779B97F4A7C15;
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        private struct Header
+        {
+            public uint magic;
+            public uint version;
+            public int parserVersion;
+            public int entryCount;
+        }
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        private struct Entry
+        {
+            public ulong hash;
+            public int sourceLength;
+            public int offset;
+            public int length;
+        }
+
+        private readonly Dictionary<(ulong hash, int sourceLength), ReadOnlyMemory<byte>> segments =
+            new Dictionary<(ulong, int), ReadOnlyMemory<byte>>();
+        private readonly HashSet<(ulong hash, int sourceLength)> usedSegments = new HashSet<(ulong, int)>();
+        private bool isDirty;
+
+        public string FilePath { get; }
+
+        public SyntaxCache(string filePath)
+        {
+            FilePath = filePath;
+            byte[] file;
+            try
+            {
+                file = File.ReadAllBytes(filePath);
+            }
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                return;
+            }
+
+            var span = file.AsSpan();
+            int headerSize = Marshal.SizeOf<Header>();
+            if (span.Length < headerSize)
+                return;
+            var header = MemoryMarshal.Read<Header>(span);
+            long entriesSize = (long)header.entryCount * Marshal.SizeOf<Entry>();
+            if (header.magic != Magic ||
+                header.version != Version ||
+                header.parserVersion != Parser.Version ||
+                header.entryCount < 0 ||
+                headerSize + entriesSize > span.Length)
+                return;
+            var entries = MemoryMarshal.Cast<byte, Entry>(span.Slice(headerSize, (int)entriesSize));
+            int dataStart = headerSize + (int)entriesSize;
+            foreach (var entry in entries)
+            {
+                if (entry.offset < 0 || entry.length < 0 || (long)dataStart + entry.offset + entry.length > span.Length)
+                {
+                    segments.Clear();
+                    return;
+                }
+                segments[(entry.hash, entry.sourceLength)] = file.AsMemory(dataStart + entry.offset, entry.length);
+            }
+        }
+
+        /// <summary>Opens the cache file of <paramref name="name"/>, null if <paramref name="cachePath"/> is null to disable caching</summary>
+        public static SyntaxCache? Open(string? cachePath, string name) => cachePath == null
+            ? null
+            : new SyntaxCache(Path.Combine(cachePath, "syntax", $"{Hash(MemoryMarshal.AsBytes(name.AsSpan()), 0):x16}.ast"));
+
+        /// <summary>Hashes the source text with the name of its parser, it only has to tell different sources apart</summary>
+        internal static ulong Hash(ReadOnlySpan<byte> source, ulong seed)
+        {
+            ulong hash = seed ^ (ulong)source.Length;
+            var words = MemoryMarshal.Cast<byte, ulong>(source);
+            foreach (var word in words)
+                hash = BitOperations.RotateLeft((hash ^ word) * HashPrime, 31);
+            foreach (var value in source.Slice(words.Length * sizeof(ulong)))
+                hash = BitOperations.RotateLeft((hash ^ value) * HashPrime, 31);
+            hash ^= hash >> 29;
+            hash *= HashPrime;
+            return hash ^ (hash >> 32);
+        }
+
+        internal static (ulong hash, int sourceLength) KeyOf(ReadOnlySpan<byte> source, string parserName) =>
+            (Hash(source, Hash(MemoryMarshal.AsBytes(parserName.AsSpan()), 0)), source.Length);
+
+        internal bool TryLoad((ulong hash, int sourceLength) key, SyntaxArena arena, int file, List<int> lineStarts, IdentifierTable identifiers, out int root)
+        {
+            root = -1;
+            if (!segments.TryGetValue(key, out var segment))
+                return false;
+            if (!arena.TryImportSegment(segment.Span, file, lineStarts, identifiers, out root))
+            {
+                segments.Remove(key);
+                isDirty = true;
+                return false;
+            }
+            usedSegments.Add(key);
+            return true;
+        }
+
+        internal void Store((ulong hash, int sourceLength) key, byte[] segment)
+        {
+            segments[key] = segment;
+            usedSegments.Add(key);
+            isDirty = true;
+        }
+
+        /// <summary>Writes the file if trees were added or are not used anymore</summary>
+        public void Save()
+        {
+            if (!isDirty && usedSegments.Count == segments.Count)
+                return;
+
+            var entries = new List<Entry>();
+            var data = new MemoryStream();
+            foreach (var key in usedSegments)
+            {
+                var segment = segments[key];
+                entries.Add(new Entry
+                {
+                    hash = key.hash,
+                    sourceLength = key.sourceLength,
+                    offset = (int)data.Length,
+                    length = segment.Length
+                });
+                data.Write(segment.Span);
+            }
+            var header = new Header
+            {
+                magic = Magic,
+                version = Version,
+                parserVersion = Parser.Version,
+                entryCount = entries.Count
+            };
+
+            var tempPath = $"{FilePath}.{Guid.NewGuid():N}.tmp"; // unique, the same scene may be saved by concurrent loads
+            try
+            {
+                Directory.CreateDirectory(Path.GetDirectoryName(FilePath)!);
+                using (var stream = new FileStream(tempPath, FileMode.Create, FileAccess.Write))
+                {
+                    stream.Write(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref header, 1)));
+                    stream.Write(MemoryMarshal.AsBytes(CollectionsMarshal.AsSpan(entries)));
+                    stream.Write(data.GetBuffer(), 0, (int)data.Length);
+                }
+                File.Move(tempPath, FilePath, overwrite: true);
+            }
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                Console.WriteLine($"Warning: Could not write syntax cache {FilePath}: {e.Message}");
+                try { File.Delete(tempPath); } catch (IOException) { }
+            }
+            foreach (var key in segments.Keys)
+            {
+                if (!usedSegments.Contains(key))
+                    segments.Remove(key);
+            }
+            isDirty = false;
+        }
+    }
+}
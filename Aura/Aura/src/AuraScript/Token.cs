@@ -31,12 +31,15 @@ namespace Aura.Script
         public TokenType Type { get; }
         public ScriptPos Pos { get; }
         public string Value { get; }
+        /// <summary>The value of number tokens, already parsed by the tokenizer</summary>
+        public double Number { get; }
 
-        public Token(TokenType type, ScriptPos pos, string value = "")
+        public Token(TokenType type, ScriptPos pos, string value = "", double number = 0)
         {
             Type = type;
             Pos = pos;
             Value = value;
+            Number = number;
         }
     }
 }
@@ -1,46 +1,56 @@
 ﻿using System;
 using System.Collections.Generic;
-using System.Linq;
-using System.Text;
-using System.IO;
 using System.Collections;
-using System.Runtime.Serialization;
+using System.Globalization;
+using System.Runtime.InteropServices;
 
 namespace Aura.Script
 {
+    /// <summary>Scans script texts in place, tokens only allocate for identifiers which were not interned yet</summary>
     public class Tokenizer : IEnumerable<Token>
     {
-        private string file;
-        private string text;
+        private readonly string file;
+        private readonly ReadOnlyMemory<char> text;
+        private readonly ReadOnlyMemory<byte> asciiText;
+        private readonly bool isAscii;
+        private readonly IdentifierTable identifiers;
 
-        public Tokenizer(string file, string text)
+        public Tokenizer(string file, string text, IdentifierTable? identifiers = null)
+            : this(file, text.AsMemory(), identifiers) { }
+
+        public Tokenizer(string file, ReadOnlyMemory<char> text, IdentifierTable? identifiers = null)
         {
             this.file = file;
             this.text = text;
+            this.identifiers = identifiers ?? new IdentifierTable();
+        }
+
+        /// <summary>Scans the ASCII bytes of a script directly, bytes outside of ASCII are read as '?'</summary>
+        public Tokenizer(string file, ReadOnlyMemory<byte> asciiText, IdentifierTable? identifiers = null)
+        {
+            this.file = file;
+            this.asciiText = asciiText;
+            this.identifiers = identifiers ?? new IdentifierTable();
+            isAscii = true;
         }
 
+        public string File => file;
+        public IdentifierTable Identifiers => identifiers;
+        /// <summary>The raw bytes of the script text, identifies the source for the syntax cache</summary>
+        internal ReadOnlySpan<byte> SourceBytes => isAscii ? asciiText.Span : MemoryMarshal.AsBytes(text.Span);
+
         public TokenizerEnumerator GetEnumerator() => new TokenizerEnumerator(this);
         IEnumerator<Token> IEnumerable<Token>.GetEnumerator() => GetEnumerator();
         IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
 
         public sealed class TokenizerEnumerator : IEnumerator<Token>, IEnumerator
         {
-            private static readonly IReadOnlyDictionary<char, TokenType> SingleCharTokens = new Dictionary<char, TokenType>()
-            {
-                { '{', TokenType.BlockBracketOpen },
-                { '}', TokenType.BlockBracketClose },
-                { '(', TokenType.ExprBracketOpen },
-                { ')', TokenType.ExprBracketClose },
-                { '[', TokenType.TupleBracketOpen },
-                { ']', TokenType.TupleBracketClose },
-                { ';', TokenType.Semicolon },
-                { ':', TokenType.Colon },
-                { ',', TokenType.Comma }
-            };
+            private const int MaxStackNumberLength = 64;
 
             private Tokenizer source;
-            private TextReader reader = null!; // will be set by Reset in ctor
-            private ScriptPos position;
+            private int offset;
+            private int line;
+            private int lineStart;
             private bool didSendEoS;
 
             internal TokenizerEnumerator(Tokenizer source)
@@ -51,152 +61,182 @@ namespace Aura.Script
 
             public Token Current { get; private set; }
             object IEnumerator.Current => Current;
+            /// <summary>The offsets of the lines scanned so far</summary>
+            internal List<int> LineStarts { get; private set; } = null!; // will be set by Reset in ctor
+
+            private ScriptPos Position => new ScriptPos(source.file, offset, line, offset - lineStart);
 
             public void Dispose() { }
 
             public void Reset()
             {
-                reader = new StringReader(source.text);
-                position = new ScriptPos(source.file);
-                Current = new Token(TokenType.EndOfSource, position);
+                offset = 0;
+                line = 0;
+                lineStart = 0;
+                LineStarts = new List<int>() { 0 };
+                Current = new Token(TokenType.EndOfSource, Position);
                 didSendEoS = false;
             }
 
-            private int Peek() => reader.Peek();
-            
-            private int Read()
+            public void SkipToNextLine()
+            {
+                if (source.isAscii)
+                    SkipToNextLine(source.asciiText.Span);
+                else
+                    SkipToNextLine(source.text.Span);
+            }
+
+            public bool MoveNext() => source.isAscii
+                ? MoveNext(source.asciiText.Span)
+                : MoveNext(source.text.Span);
+
+            private static int Peek<TChar>(ReadOnlySpan<TChar> text, int index) where TChar : unmanaged =>
+                index < text.Length ? ScriptCharacters.At(text, index) : -1;
+
+            private static int ScanWhile<TChar>(ReadOnlySpan<TChar> text, int index, CharacterClass @class) where TChar : unmanaged
             {
-                int result = reader.Read();
-                position = result == '\n'
-                    ? position.NextLine
-                    : position.NextColumn;
-                return result;
+                while (index < text.Length && ScriptCharacters.Is(ScriptCharacters.At(text, index), @class))
+                    index++;
+                return index;
             }
 
-            private void SkipSpaceAndComments()
+            private void SkipLineBreak()
             {
-                int ch = Peek();
-                while (ch >= 0)
+                offset++;
+                line++;
+                lineStart = offset;
+                LineStarts.Add(offset);
+            }
+
+            private void SkipSpaceAndComments<TChar>(ReadOnlySpan<TChar> text) where TChar : unmanaged
+            {
+                while (offset < text.Length)
                 {
-                    if (char.IsWhiteSpace((char)ch))
-                        Read();
-                    else if (ch == '*' || ch == '/' || ch == '?')
-                        SkipToNextLine();
+                    int ch = ScriptCharacters.At(text, offset);
+                    var @class = ScriptCharacters.Classify(ch);
+                    if (ch == '\n')
+                        SkipLineBreak();
+                    else if ((@class & CharacterClass.Space) != 0)
+                        offset++;
+                    else if ((@class & CharacterClass.CommentStart) != 0)
+                        SkipToNextLine(text);
                     else
                         return;
-                    ch = Peek();
                 }
             }
 
-            public void SkipToNextLine()
+            private void SkipToNextLine<TChar>(ReadOnlySpan<TChar> text) where TChar : unmanaged
             {
-                int ch = Peek();
-                while (ch >= 0 && ch != '\n')
-                    ch = Read();
+                while (offset < text.Length)
+                {
+                    if (ScriptCharacters.At(text, offset) == '\n')
+                    {
+                        SkipLineBreak();
+                        return;
+                    }
+                    offset++;
+                }
             }
 
-            public string ReadWhile(string prefix, Predicate<char> isValid)
+            private bool Emit(TokenType type, int start, string value = "", double number = 0)
             {
-                string value = prefix;
-                int chI = Peek();
-                while (chI >= 0 && isValid((char)chI))
-                {
-                    value += (char)Read();
-                    chI = Peek();
-                }
-                return value;
+                var pos = new ScriptPos(source.file, start, line, start - lineStart, offset - start);
+                Current = new Token(type, pos, value, number);
+                return true;
             }
 
-            public bool MoveNext()
+            private bool MoveNext<TChar>(ReadOnlySpan<TChar> text) where TChar : unmanaged
             {
-                SkipSpaceAndComments();
-                int chI = Peek();
-                if (chI < 0)
+                SkipSpaceAndComments(text);
+                if (offset >= text.Length)
                 {
                     bool result = !didSendEoS;
                     didSendEoS = true;
-                    Current = new Token(TokenType.EndOfSource, position);
+                    Current = new Token(TokenType.EndOfSource, Position);
                     return result;
                 }
-                char ch = (char)chI;
 
-                ScriptPos tokenStart = position;
-                if (char.IsLetter(ch) || "_.\\$@&%".Contains(ch))
+                int start = offset;
+                int ch = ScriptCharacters.At(text, offset);
+                var @class = ScriptCharacters.Classify(ch);
+                if ((@class & CharacterClass.IdentifierStart) != 0)
                 {
-                    string value = "" + (char)Read();
-                    if (ch == '&' && Peek() == '&')
+                    offset++;
+                    if (ch == '&' && Peek(text, offset) == '&')
                     {
-                        Read();
-                        Current = new Token(TokenType.LogicalAnd, position - tokenStart);
-                        return true;
+                        offset++;
+                        return Emit(TokenType.LogicalAnd, start);
                     }
 
-                    value = ReadWhile(value, c => char.IsLetterOrDigit(c) || "_.\\".Contains(c));
-                    Current = new Token(TokenType.Identifier, position - tokenStart, value);
-                    return true;
+                    offset = ScanWhile(text, offset, CharacterClass.IdentifierPart);
+                    return Emit(TokenType.Identifier, start, source.identifiers.Intern(text[start..offset]));
                 }
 
                 if (ch == '\"')
                 {
-                    Read();
-                    string value = ReadWhile("", c => c >= 128 || (!char.IsControl(c) && c != '\"'));
-                    if (Peek() != '\"')
-                        throw new Exception($"Unexpected symbol '{(char)Peek()}', expected '\"'");
-                    Read();
-                    Current = new Token(TokenType.Identifier, position - tokenStart, value);
-                    return true;
+                    int end = ScanWhile(text, offset + 1, CharacterClass.StringPart);
+                    if (Peek(text, end) != '\"')
+                        throw new Exception($"Unexpected symbol '{(char)Peek(text, end)}', expected '\"'");
+                    offset = end + 1;
+                    return Emit(TokenType.Identifier, start, source.identifiers.Intern(text[(start + 1)..end]));
                 }
 
-                if (char.IsDigit(ch) || ch == '-')
+                if ((@class & CharacterClass.NumberStart) != 0)
                 {
-                    string value = ReadWhile("" + (char)Read(), c => char.IsDigit(c) || c == '.');
-                    if (!double.TryParse(value, out var _))
+                    offset = ScanWhile(text, offset + 1, CharacterClass.NumberPart);
+                    var numberText = text[start..offset];
+                    if (!TryParseNumber(numberText, out var number))
                         throw new Exception("Invalid number format");
-                    Current = new Token(TokenType.Number, position - tokenStart, value);
-                    return true;
+                    return Emit(TokenType.Number, start, source.identifiers.Intern(numberText), number);
                 }
 
                 if (ch == '|')
                 {
-                    Read();
-                    if (Peek() != '|')
-                        throw new Exception($"Unexpected symbol '{(char)Peek()}', expected '|'");
-                    Read();
-                    Current = new Token(TokenType.LogicalOr, position - tokenStart);
-                    return true;
+                    if (Peek(text, offset + 1) != '|')
+                        throw new Exception($"Unexpected symbol '{(char)Peek(text, offset + 1)}', expected '|'");
+                    offset += 2;
+                    return Emit(TokenType.LogicalOr, start);
                 }
 
                 if (ch == '=')
                 {
-                    Read();
-                    if (Peek() == '=')
-                    {
-                        Read();
-                        Current = new Token(TokenType.Equals, position - tokenStart);
-                    }
-                    else
-                        Current = new Token(TokenType.Assign, position - tokenStart);
-                    return true;
+                    offset++;
+                    if (Peek(text, offset) != '=')
+                        return Emit(TokenType.Assign, start);
+                    offset++;
+                    return Emit(TokenType.Equals, start);
                 }
 
                 if (ch == '!')
                 {
-                    Read();
-                    if (Peek() != '=')
-                        throw new Exception($"Unexpected symbol '{(char)Peek()}', expected '='");
-                    Read();
-                    Current = new Token(TokenType.NotEquals, position - tokenStart);
-                    return true;
+                    if (Peek(text, offset + 1) != '=')
+                        throw new Exception($"Unexpected symbol '{(char)Peek(text, offset + 1)}', expected '='");
+                    offset += 2;
+                    return Emit(TokenType.NotEquals, start);
                 }
 
-                if (SingleCharTokens.ContainsKey(ch))
+                var singleCharToken = ScriptCharacters.SingleCharToken(ch);
+                if (singleCharToken.HasValue)
                 {
-                    Read();
-                    Current = new Token(SingleCharTokens[ch], position - tokenStart);
-                    return true;
+                    offset++;
+                    return Emit(singleCharToken.Value, start);
                 }
 
-                throw new Exception($"Unexpected symbol '{ch}'");
+                throw new Exception($"Unexpected symbol '{(char)ch}'");
+            }
+
+            private static bool TryParseNumber<TChar>(ReadOnlySpan<TChar> text, out double number) where TChar : unmanaged
+            {
+                const NumberStyles Style = NumberStyles.AllowLeadingSign | NumberStyles.AllowDecimalPoint;
+                if (typeof(TChar) == typeof(char))
+                    return double.TryParse(MemoryMarshal.Cast<TChar, char>(text), Style, CultureInfo.InvariantCulture, out number);
+
+                var chars = text.Length <= MaxStackNumberLength
+                    ? stackalloc char[text.Length]
+                    : new char[text.Length];
+                for (int i = 0; i < text.Length; i++)
+                    chars[i] = (char)ScriptCharacters.At(text, i);
+                return double.TryParse(chars, Style, CultureInfo.InvariantCulture, out number);
             }
         }
     }
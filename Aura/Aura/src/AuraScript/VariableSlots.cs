@@ -0,0 +1,57 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace Aura.Script
+{
+    /// <summary>Interns the variable names of a set to dense slots, a slot is never reassigned to another name</summary>
+    public class VariableSlots
+    {
+        private readonly object slotsLock = new object();
+        private readonly Dictionary<string, int> slots = new Dictionary<string, int>();
+        private readonly List<string> names = new List<string>();
+
+        public int Count
+        {
+            get
+            {
+                lock (slotsLock)
+                    return names.Count;
+            }
+        }
+
+        public VariableSlots() { }
+
+        /// <summary>Interns the given names in order, so their slots are the indices of the sequence</summary>
+        public VariableSlots(IEnumerable<string> names)
+        {
+            foreach (var name in names)
+                GetSlot(name);
+        }
+
+        public int GetSlot(string name)
+        {
+            lock (slotsLock)
+            {
+                if (!slots.TryGetValue(name, out var slot))
+                {
+                    slot = names.Count;
+                    names.Add(name);
+                    slots.Add(name, slot);
+                }
+                return slot;
+            }
+        }
+
+        public bool TryGetSlot(string name, out int slot)
+        {
+            lock (slotsLock)
+                return slots.TryGetValue(name, out slot);
+        }
+
+        public string GetName(int slot)
+        {
+            lock (slotsLock)
+                return names[slot];
+        }
+    }
+}
@@ -0,0 +1,69 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+
+namespace Aura
+{
+    public readonly struct AssetAccess
+    {
+        public TimeSpan Time { get; }
+        public string Scene { get; }
+        public string Path { get; }
+
+        public AssetAccess(TimeSpan time, string scene, string path)
+        {
+            Time = time;
+            Scene = scene;
+            Path = path;
+        }
+
+        public override string ToString() => $"{Time.TotalMilliseconds.ToString("F3", CultureInfo.InvariantCulture)}\t{Scene}\t{Path}";
+    }
+
+    /// <summary>Opt-in recorder of asset accesses for optimizing the pack layouts</summary>
+    /// <remarks>Traces are tab-separated text with one access per line: milliseconds, scene, path</remarks>
+    public class AssetAccessTracer : BaseDisposable
+    {
+        private readonly object writerLock = new object();
+        private readonly Stopwatch stopwatch = Stopwatch.StartNew();
+        private readonly TextWriter writer;
+
+        public string CurrentScene { get; set; } = "";
+
+        public AssetAccessTracer(TextWriter writer)
+        {
+            this.writer = writer;
+        }
+
+        protected override void DisposeManaged()
+        {
+            lock (writerLock)
+                writer.Dispose();
+        }
+
+        public void Record(ReadOnlySpan<char> path)
+        {
+            var access = new AssetAccess(stopwatch.Elapsed, CurrentScene, path.ToString());
+            lock (writerLock)
+                writer.WriteLine(access.ToString());
+        }
+
+        public static IEnumerable<AssetAccess> ReadTrace(TextReader reader)
+        {
+            string? line;
+            int lineNumber = 0;
+            while ((line = reader.ReadLine()) != null)
+            {
+                lineNumber++;
+                if (line.Length == 0)
+                    continue;
+                var parts = line.Split('\t');
+                if (parts.Length != 3 || !double.TryParse(parts[0], NumberStyles.Float, CultureInfo.InvariantCulture, out var milliseconds))
+                    throw new InvalidDataException($"Invalid asset trace line {lineNumber}");
+                yield return new AssetAccess(TimeSpan.FromMilliseconds(milliseconds), parts[1], parts[2]);
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+﻿using System;
+using System.Buffers;
+using System.IO;
+using System.Runtime.ExceptionServices;
+using System.Threading;
+
+namespace Aura
+{
+    public readonly struct AssetReadRequest
+    {
+        public string Path { get; }
+        public long Offset { get; }
+        /// <summary>Number of bytes to read or null to read until the end of the asset</summary>
+        public int? Length { get; }
+
+        public AssetReadRequest(string path, long offset = 0, int? length = null)
+        {
+            Path = path;
+            Offset = offset;
+            Length = length;
+        }
+
+        public override string ToString() => $"{Path} ({Length?.ToString() ?? "all"} bytes at {Offset})";
+    }
+
+    /// <summary>Location of an asset that can be read directly from a file</summary>
+    public readonly struct AssetLocation
+    {
+        public string FilePath { get; }
+        public long Offset { get; }
+        /// <summary>Length of the asset or null if it spans until the end of the file</summary>
+        public long? Length { get; }
+
+        public AssetLocation(string filePath, long offset, long? length)
+        {
+            FilePath = filePath;
+            Offset = offset;
+            Length = length;
+        }
+    }
+
+    /// <summary>Asset content in a pooled array, the array is returned on dispose</summary>
+    /// <remarks>A buffer of an asset that could not be read has no content and rethrows the error when it is accessed</remarks>
+    public sealed class AssetBuffer : IDisposable
+    {
+        private sealed class OwningStream : MemoryStream
+        {
+            private readonly AssetBuffer buffer;
+
+            public OwningStream(AssetBuffer buffer) : base(buffer.array!, 0, buffer.Length, writable: false) =>
+                this.buffer = buffer;
+
+            protected override void Dispose(bool disposing)
+            {
+                base.Dispose(disposing);
+                buffer.Dispose();
+            }
+        }
+
+        private byte[]? array;
+        private readonly ExceptionDispatchInfo? error;
+
+        public int Length { get; }
+        public bool IsFaulted => error != null;
+        public ReadOnlyMemory<byte> Memory
+        {
+            get
+            {
+                error?.Throw();
+                return array == null
+                    ? throw new ObjectDisposedException(nameof(AssetBuffer))
+                    : array.AsMemory(0, Length);
+            }
+        }
+
+        internal AssetBuffer(int length)
+        {
+            array = ArrayPool<byte>.Shared.Rent(length);
+            Length = length;
+        }
+
+        private AssetBuffer(Exception error)
+        {
+            this.error = ExceptionDispatchInfo.Capture(error);
+        }
+
+        internal static AssetBuffer FromError(Exception error) => new AssetBuffer(error);
+
+        internal Memory<byte> WritableMemory => array!.AsMemory(0, Length);
+
+        public void Dispose()
+        {
+            var oldArray = Interlocked.Exchange(ref array, null);
+            if (oldArray != null)
+                ArrayPool<byte>.Shared.Return(oldArray);
+        }
+
+        /// <summary>Wraps the buffer into a stream which takes ownership of it</summary>
+        public Stream ToStream()
+        {
+            error?.Throw();
+            if (array == null)
+                throw new ObjectDisposedException(nameof(AssetBuffer));
+            return new OwningStream(this);
+        }
+    }
+}
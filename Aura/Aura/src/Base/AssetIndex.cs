@@ -0,0 +1,70 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace Aura
+{
+    /// <summary>Case-insensitive lookup table of asset names by sorted hashes</summary>
+    public class AssetIndex
+    {
+        private readonly IReadOnlyList<string> names;
+        private readonly ulong[] sortedHashes;
+        private readonly int[] sortedIndices;
+
+        public AssetIndex(IReadOnlyList<string> names)
+        {
+            this.names = names;
+            sortedHashes = new ulong[names.Count];
+            sortedIndices = new int[names.Count];
+            for (int i = 0; i < names.Count; i++)
+            {
+                sortedHashes[i] = AssetName.Hash(names[i]);
+                sortedIndices[i] = i;
+            }
+            Array.Sort(sortedHashes, sortedIndices);
+        }
+
+        /// <summary>Takes the hashes as already sorted e.g. by an index cache, names are only read to confirm a match</summary>
+        internal AssetIndex(IReadOnlyList<string> names, ulong[] sortedHashes, int[] sortedIndices)
+        {
+            if (sortedHashes.Length != names.Count || sortedIndices.Length != names.Count)
+                throw new ArgumentException("Every name needs a hash and an index");
+            this.names = names;
+            this.sortedHashes = sortedHashes;
+            this.sortedIndices = sortedIndices;
+        }
+
+        internal ReadOnlySpan<ulong> SortedHashes => sortedHashes;
+        internal ReadOnlySpan<int> SortedIndices => sortedIndices;
+
+        /// <summary>Returns the index of the name in the original list or -1</summary>
+        public int IndexOf(ReadOnlySpan<char> name)
+        {
+            var hash = AssetName.Hash(name);
+            int i = Array.BinarySearch(sortedHashes, hash);
+            if (i < 0)
+                return -1;
+            while (i > 0 && sortedHashes[i - 1] == hash)
+                i--;
+            for (; i < sortedHashes.Length && sortedHashes[i] == hash; i++)
+            {
+                if (AssetName.Equals(names[sortedIndices[i]], name))
+                    return sortedIndices[i];
+            }
+            return -1;
+        }
+
+        public string? FindDuplicate()
+        {
+            for (int i = 1; i < sortedHashes.Length; i++)
+            {
+                // equal names are adjacent unless there is a hash collision in between
+                for (int j = i - 1; j >= 0 && sortedHashes[j] == sortedHashes[i]; j--)
+                {
+                    if (AssetName.Equals(names[sortedIndices[j]], names[sortedIndices[i]]))
+                        return names[sortedIndices[i]];
+                }
+            }
+            return null;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+﻿using System;
+
+namespace Aura
+{
+    /// <summary>Case-insensitive hashing and comparison of asset names without allocating lowered copies</summary>
+    public static class AssetName
+    {
+        public const ulong EmptyHash = 14695981039346656037; // FNV-1a offset basis
+        private const ulong FnvPrime = 1099511628211;
+
+        public static char Normalize(char ch) => ch switch
+        {
+            >= 'A' and <= 'Z' => (char)(ch + ('a' - 'A')),
+            '\\' => '/',
+            < (char)128 => ch,
+            _ => char.ToLowerInvariant(ch)
+        };
+
+        /// <summary>Hashes the normalized name, pass a previous hash to continue hashing e.g. after a prefix</summary>
+        public static ulong Hash(ReadOnlySpan<char> name, ulong hash = EmptyHash)
+        {
+            foreach (var ch in name)
+            {
+                hash ^= Normalize(ch);
+                hash *= FnvPrime;
+            }
+            return hash;
+        }
+
+        public static bool Equals(ReadOnlySpan<char> a, ReadOnlySpan<char> b)
+        {
+            if (a.Length != b.Length)
+                return false;
+            for (int i = 0; i < a.Length; i++)
+            {
+                if (a[i] != b[i] && Normalize(a[i]) != Normalize(b[i]))
+                    return false;
+            }
+            return true;
+        }
+    }
+}
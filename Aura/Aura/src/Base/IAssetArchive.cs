@@ -0,0 +1,13 @@
+﻿using System;
+using System.IO;
+
+namespace Aura
+{
+    public interface IAssetArchive : IDisposable
+    {
+        bool HasAsset(ReadOnlySpan<char> name);
+        Stream? OpenAsset(ReadOnlySpan<char> name);
+        /// <summary>Locates assets that are stored unmodified in a file to allow reading them without the archive</summary>
+        bool TryLocateAsset(ReadOnlySpan<char> name, out AssetLocation location);
+    }
+}
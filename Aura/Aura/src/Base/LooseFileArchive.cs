@@ -0,0 +1,51 @@
+﻿using System;
+using System.IO;
+using System.Linq;
+
+namespace Aura
+{
+    /// <summary>Index of all files below a directory, scanned once at construction</summary>
+    public class LooseFileArchive : IAssetArchive
+    {
+        private readonly string[] relativePaths;
+        private readonly AssetIndex index;
+
+        public string RootPath { get; }
+
+        public LooseFileArchive(string rootPath)
+        {
+            RootPath = Path.GetFullPath(rootPath);
+            relativePaths = Directory
+                .EnumerateFiles(RootPath, "*", SearchOption.AllDirectories)
+                .Select(p => Path.GetRelativePath(RootPath, p))
+                .ToArray();
+            index = new AssetIndex(relativePaths);
+        }
+
+        public void Dispose() { }
+
+        public bool HasAsset(ReadOnlySpan<char> name) => index.IndexOf(name) >= 0;
+
+        public bool TryLocateAsset(ReadOnlySpan<char> name, out AssetLocation location)
+        {
+            int i = index.IndexOf(name);
+            location = i < 0 ? default : new AssetLocation(Path.Combine(RootPath, relativePaths[i]), 0, null);
+            return i >= 0;
+        }
+
+        public Stream? OpenAsset(ReadOnlySpan<char> name)
+        {
+            int i = index.IndexOf(name);
+            if (i < 0)
+                return null;
+            try
+            {
+                return new FileStream(Path.Combine(RootPath, relativePaths[i]), FileMode.Open, FileAccess.Read);
+            }
+            catch (IOException)
+            {
+                return null; // the file was removed after scanning
+            }
+        }
+    }
+}
@@ -0,0 +1,337 @@
+﻿using System;
+using System.Buffers;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.IO.MemoryMappedFiles;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Aura
+{
+    public enum NativeEntryKind : byte
+    {
+        Asset,
+        /// <summary>Already decoded script text as UTF-8</summary>
+        Script
+    }
+
+    public enum NativeCompression : byte
+    {
+        None,
+        /// <summary>Independent Brotli blocks of <see cref="NativePackFormat.BlockSize"/> uncompressed bytes</summary>
+        Brotli
+    }
+
+    internal static class NativePackFormat
+    {
+        public const uint Magic = 0x31504E41; // ANP1
+        public const uint Version = 2;
+        public const int PageSize = 4096;
+        public const int BlockSize = 256 * 1024;
+
+        /// <summary>The packs a native pack is converted from, their stamps follow the header in this order</summary>
+        public static readonly string[] SourceExtensions = { ".psp", ".pvd", ".psc" };
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        public struct Header
+        {
+            public uint magic;
+            public uint version;
+            public int entryCount;
+            public int nameTableSize;
+            public int blockSize;
+            public int reserved0, reserved1, reserved2;
+        }
+
+        /// <summary>Size and modification time of a source pack, to notice packs patched after the conversion</summary>
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        public struct SourceStamp
+        {
+            public long length; // -1 if the pack does not exist
+            public long lastWriteTime;
+
+            public static SourceStamp Of(string? filePath)
+            {
+                var info = filePath == null ? null : new FileInfo(filePath);
+                return info == null || !info.Exists
+                    ? new SourceStamp { length = -1 }
+                    : new SourceStamp { length = info.Length, lastWriteTime = info.LastWriteTimeUtc.Ticks };
+            }
+        }
+
+        /// <summary>The records are sorted by hash to allow a binary search directly on the directory</summary>
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        public struct Record
+        {
+            public ulong hash;
+            public long offset;
+            public int length;
+            public int storedLength;
+            public int nameOffset;
+            public ushort nameLength;
+            public NativeEntryKind kind;
+            public NativeCompression compression;
+            public int blockCount;
+            public int reserved;
+        }
+
+        public static long DirectorySize(int entryCount, int nameTableSize) => checked(
+            Marshal.SizeOf<Header>() +
+            SourceExtensions.Length * Marshal.SizeOf<SourceStamp>() +
+            (long)entryCount * Marshal.SizeOf<Record>() +
+            nameTableSize);
+
+        public static long AlignToPage(long offset) => (offset + PageSize - 1) / PageSize * PageSize;
+
+        public static void ReadExactly(Stream stream, Span<byte> buffer)
+        {
+            while (buffer.Length > 0)
+            {
+                int read = stream.Read(buffer);
+                if (read <= 0)
+                    throw new EndOfStreamException("Unexpected end of native pack");
+                buffer = buffer.Slice(read);
+            }
+        }
+    }
+
+    /// <summary>Engine-native scene container (.anp) with page-aligned unencrypted entries</summary>
+    /// <remarks>
+    /// Uncompressed entries are served as views of the mapped file. Compressed entries are split
+    /// into blocks which are decompressed in parallel into a single buffer.
+    /// </remarks>
+    public class NativePackArchive : BaseDisposable, IAssetArchive
+    {
+        private readonly NativePackFormat.SourceStamp[] sourceStamps;
+        private readonly NativePackFormat.Record[] records;
+        private readonly string[] names;
+        private readonly MemoryMappedFile? mappedFile;
+        private readonly byte[]? memoryContent;
+        private readonly string? filePath;
+
+        public NativePackArchive(Stream stream)
+        {
+            if (!(stream is FileStream))
+            {
+                var memoryStream = new MemoryStream();
+                stream.CopyTo(memoryStream);
+                stream.Dispose();
+                memoryContent = memoryStream.GetBuffer();
+                stream = new MemoryStream(memoryContent, 0, (int)memoryStream.Length, writable: false);
+            }
+
+            var headerBytes = new byte[Marshal.SizeOf<NativePackFormat.Header>()];
+            NativePackFormat.ReadExactly(stream, headerBytes);
+            var header = MemoryMarshal.Read<NativePackFormat.Header>(headerBytes);
+            if (header.magic != NativePackFormat.Magic || header.version != NativePackFormat.Version)
+                throw new InvalidDataException("Invalid native pack header");
+            if (header.entryCount < 0 || header.nameTableSize < 0 || header.blockSize != NativePackFormat.BlockSize ||
+                NativePackFormat.DirectorySize(header.entryCount, header.nameTableSize) > Math.Min(stream.Length, int.MaxValue))
+                throw new InvalidDataException("Invalid native pack directory");
+
+            var directory = new byte[NativePackFormat.DirectorySize(header.entryCount, header.nameTableSize) - headerBytes.Length];
+            NativePackFormat.ReadExactly(stream, directory);
+            int stampsSize = NativePackFormat.SourceExtensions.Length * Marshal.SizeOf<NativePackFormat.SourceStamp>();
+            sourceStamps = MemoryMarshal.Cast<byte, NativePackFormat.SourceStamp>(directory.AsSpan(0, stampsSize)).ToArray();
+            records = MemoryMarshal.Cast<byte, NativePackFormat.Record>(directory.AsSpan(stampsSize, directory.Length - stampsSize - header.nameTableSize)).ToArray();
+            var nameTable = directory.AsSpan(directory.Length - header.nameTableSize);
+            names = new string[records.Length];
+            for (int i = 0; i < records.Length; i++)
+            {
+                ref readonly var record = ref records[i];
+                if (record.nameOffset < 0 || record.nameOffset > nameTable.Length - record.nameLength ||
+                    record.offset < 0 || record.storedLength < 0 || record.offset > stream.Length - record.storedLength ||
+                    !IsValidContent(record))
+                    throw new InvalidDataException($"Native pack entry {i} is out of bounds");
+                names[i] = Encoding.UTF8.GetString(nameTable.Slice(record.nameOffset, record.nameLength));
+                if (record.hash != AssetName.Hash(names[i]) || (i > 0 && record.hash < records[i - 1].hash))
+                    throw new InvalidDataException($"Native pack entry {i} is not sorted by its hash");
+            }
+
+            filePath = (stream as FileStream)?.Name;
+            if (memoryContent == null && stream.Length > 0)
+                mappedFile = MemoryMappedFile.CreateFromFile((FileStream)stream, null, 0, MemoryMappedFileAccess.Read, HandleInheritability.None, leaveOpen: false);
+            else
+                stream.Dispose();
+        }
+
+        private static bool IsValidContent(in NativePackFormat.Record record)
+        {
+            if (record.length < 0 || (record.kind != NativeEntryKind.Asset && record.kind != NativeEntryKind.Script))
+                return false;
+            return record.compression switch
+            {
+                NativeCompression.None => record.storedLength == record.length,
+                NativeCompression.Brotli =>
+                    record.blockCount > 0 &&
+                    (long)record.blockCount * sizeof(int) <= record.storedLength &&
+                    (long)record.blockCount * NativePackFormat.BlockSize >= record.length,
+                _ => false
+            };
+        }
+
+        protected override void DisposeManaged()
+        {
+            mappedFile?.Dispose();
+        }
+
+        /// <summary>Extensions of the packs a native pack is converted from, e.g. to locate them for <see cref="MatchesSources"/></summary>
+        public static IReadOnlyList<string> SourceExtensions => NativePackFormat.SourceExtensions;
+
+        /// <summary>Whether the packs the native pack was converted from were not changed since</summary>
+        /// <param name="sourcePaths">The file paths of the packs in the order of <see cref="SourceExtensions"/>, null if a pack does not exist</param>
+        /// <remarks>Without any source pack the native pack is the only copy of the scene and always used</remarks>
+        public bool MatchesSources(IReadOnlyList<string?> sourcePaths)
+        {
+            if (sourcePaths.Count != sourceStamps.Length)
+                throw new ArgumentException("Expected a path for every source pack", nameof(sourcePaths));
+            bool hasSources = false;
+            bool isMatching = true;
+            for (int i = 0; i < sourceStamps.Length; i++)
+            {
+                var stamp = NativePackFormat.SourceStamp.Of(sourcePaths[i]);
+                hasSources |= stamp.length >= 0;
+                isMatching &= stamp.length == sourceStamps[i].length && stamp.lastWriteTime == sourceStamps[i].lastWriteTime;
+            }
+            return isMatching || !hasSources;
+        }
+
+        public IEnumerable<string> ScriptNames
+        {
+            get
+            {
+                for (int i = 0; i < records.Length; i++)
+                {
+                    if (records[i].kind == NativeEntryKind.Script)
+                        yield return names[i];
+                }
+            }
+        }
+
+        private int FindEntry(ReadOnlySpan<char> name, NativeEntryKind kind)
+        {
+            var hash = AssetName.Hash(name);
+            int min = 0, max = records.Length;
+            while (min < max)
+            {
+                int mid = (min + max) / 2;
+                if (records[mid].hash < hash)
+                    min = mid + 1;
+                else
+                    max = mid;
+            }
+            for (int i = min; i < records.Length && records[i].hash == hash; i++)
+            {
+                if (records[i].kind == kind && AssetName.Equals(names[i], name))
+                    return i;
+            }
+            return -1;
+        }
+
+        public bool HasAsset(ReadOnlySpan<char> name) => FindEntry(name, NativeEntryKind.Asset) >= 0;
+
+        public Stream? OpenAsset(ReadOnlySpan<char> name)
+        {
+            int index = FindEntry(name, NativeEntryKind.Asset);
+            return index < 0 ? null : OpenEntry(index);
+        }
+
+        public bool TryLocateAsset(ReadOnlySpan<char> name, out AssetLocation location)
+        {
+            location = default;
+            int index = FindEntry(name, NativeEntryKind.Asset);
+            if (filePath == null || index < 0 || records[index].compression != NativeCompression.None)
+                return false;
+            location = new AssetLocation(filePath, records[index].offset, records[index].length);
+            return true;
+        }
+
+        public string? ReadScriptText(ReadOnlySpan<char> name)
+        {
+            int index = FindEntry(name, NativeEntryKind.Script);
+            if (index < 0)
+                return null;
+            using var stream = OpenEntry(index);
+            using var reader = new StreamReader(stream, Encoding.UTF8);
+            return reader.ReadToEnd();
+        }
+
+        /// <summary>Reads a script text without decoding it, the texts converted from script packs are plain ASCII</summary>
+        public ReadOnlyMemory<byte>? ReadScriptBytes(ReadOnlySpan<char> name)
+        {
+            int index = FindEntry(name, NativeEntryKind.Script);
+            if (index < 0)
+                return null;
+            var bytes = new byte[records[index].length];
+            using (var stream = OpenEntry(index))
+                NativePackFormat.ReadExactly(stream, bytes);
+            return bytes;
+        }
+
+        private Stream OpenStored(long offset, int length)
+        {
+            if (length == 0)
+                return new MemoryStream(Array.Empty<byte>(), writable: false);
+            if (mappedFile != null)
+                return mappedFile.CreateViewStream(offset, length, MemoryMappedFileAccess.Read);
+            return new MemoryStream(memoryContent!, (int)offset, length, writable: false);
+        }
+
+        private Stream OpenEntry(int index)
+        {
+            ref readonly var record = ref records[index];
+            if (record.compression == NativeCompression.None)
+                return OpenStored(record.offset, record.length);
+            if (record.compression != NativeCompression.Brotli)
+                throw new InvalidDataException($"Unsupported compression of native pack entry {names[index]}");
+
+            var stored = ArrayPool<byte>.Shared.Rent(record.storedLength);
+            try
+            {
+                using (var storedStream = OpenStored(record.offset, record.storedLength))
+                    NativePackFormat.ReadExactly(storedStream, stored.AsSpan(0, record.storedLength));
+                var content = new byte[record.length];
+                DecompressBlocks(stored, record.storedLength, content, record.blockCount, names[index]);
+                return new MemoryStream(content, writable: false);
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(stored);
+            }
+        }
+
+        private static void DecompressBlocks(byte[] stored, int storedLength, byte[] content, int blockCount, string name)
+        {
+            if (blockCount <= 0 || blockCount * sizeof(int) > storedLength)
+                throw new InvalidDataException($"Invalid compressed blocks in native pack entry {name}");
+            var blockSizes = MemoryMarshal.Cast<byte, int>(stored.AsSpan(0, blockCount * sizeof(int)));
+            var blockOffsets = new int[blockCount + 1];
+            blockOffsets[0] = blockCount * sizeof(int);
+            for (int i = 0; i < blockCount; i++)
+            {
+                if (blockSizes[i] < 0 || blockSizes[i] > storedLength - blockOffsets[i])
+                    throw new InvalidDataException($"Invalid compressed blocks in native pack entry {name}");
+                blockOffsets[i + 1] = blockOffsets[i] + blockSizes[i];
+            }
+            if (blockOffsets[blockCount] != storedLength ||
+                (long)blockCount * NativePackFormat.BlockSize < content.Length)
+                throw new InvalidDataException($"Invalid compressed blocks in native pack entry {name}");
+
+            void DecompressBlock(int i)
+            {
+                int contentOffset = i * NativePackFormat.BlockSize;
+                var source = stored.AsSpan(blockOffsets[i], blockOffsets[i + 1] - blockOffsets[i]);
+                var destination = content.AsSpan(contentOffset, Math.Min(NativePackFormat.BlockSize, content.Length - contentOffset));
+                if (!BrotliDecoder.TryDecompress(source, destination, out int written) || written != destination.Length)
+                    throw new InvalidDataException($"Could not decompress block {i} of native pack entry {name}");
+            }
+
+            if (blockCount == 1)
+                DecompressBlock(0);
+            else
+                Parallel.For(0, blockCount, DecompressBlock);
+        }
+    }
+}
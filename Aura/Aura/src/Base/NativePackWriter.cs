@@ -0,0 +1,156 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Aura
+{
+    /// <summary>Builds a <see cref="NativePackArchive"/> from decrypted entries</summary>
+    public class NativePackWriter
+    {
+        private const int BrotliQuality = 9;
+        private const int BrotliWindow = 22;
+        private const double MinCompressionRatio = 0.9; // already compressed videos are stored as-is
+
+        private class Entry
+        {
+            public string Name = "";
+            public NativeEntryKind Kind;
+            public byte[] Content = Array.Empty<byte>();
+            public byte[]? Stored;
+            public int BlockCount;
+        }
+
+        private readonly List<Entry> entries = new List<Entry>();
+        private readonly NativePackFormat.SourceStamp[] sourceStamps = NativePackFormat.SourceExtensions
+            .Select(_ => NativePackFormat.SourceStamp.Of(null))
+            .ToArray();
+
+        public bool Compress { get; set; }
+
+        /// <summary>Records size and modification time of the packs at <paramref name="basePath"/> with the <see cref="NativePackArchive.SourceExtensions"/></summary>
+        /// <remarks>Has to be called before the packs are read, a pack changed in between is then noticed as changed</remarks>
+        public void StampSources(string basePath)
+        {
+            for (int i = 0; i < sourceStamps.Length; i++)
+                sourceStamps[i] = NativePackFormat.SourceStamp.Of(basePath + NativePackFormat.SourceExtensions[i]);
+        }
+
+        public void AddAsset(string name, byte[] content) => Add(name, NativeEntryKind.Asset, content);
+        public void AddScript(string name, string text) => Add(name, NativeEntryKind.Script, Encoding.UTF8.GetBytes(text));
+
+        private void Add(string name, NativeEntryKind kind, byte[] content)
+        {
+            if (entries.Any(e => e.Kind == kind && AssetName.Equals(e.Name, name)))
+                throw new ArgumentException($"Native pack entry {name} was added twice");
+            if (Encoding.UTF8.GetByteCount(name) > ushort.MaxValue)
+                throw new ArgumentException($"Native pack entry name {name} is too long");
+            entries.Add(new Entry
+            {
+                Name = name,
+                Kind = kind,
+                Content = content
+            });
+        }
+
+        private static void CompressEntry(Entry entry)
+        {
+            if (entry.Content.Length == 0)
+                return;
+            int blockCount = (entry.Content.Length + NativePackFormat.BlockSize - 1) / NativePackFormat.BlockSize;
+            var blocks = new byte[blockCount][];
+            Parallel.For(0, blockCount, i =>
+            {
+                var source = entry.Content.AsSpan(i * NativePackFormat.BlockSize);
+                source = source.Slice(0, Math.Min(source.Length, NativePackFormat.BlockSize));
+                var destination = new byte[BrotliEncoder.GetMaxCompressedLength(source.Length)];
+                if (!BrotliEncoder.TryCompress(source, destination, out int written, BrotliQuality, BrotliWindow))
+                    throw new InvalidOperationException($"Could not compress native pack entry {entry.Name}");
+                blocks[i] = destination.AsSpan(0, written).ToArray();
+            });
+
+            int storedLength = blockCount * sizeof(int) + blocks.Sum(b => b.Length);
+            if (storedLength > entry.Content.Length * MinCompressionRatio)
+                return;
+            var stored = new byte[storedLength];
+            var blockSizes = MemoryMarshal.Cast<byte, int>(stored.AsSpan(0, blockCount * sizeof(int)));
+            int offset = blockCount * sizeof(int);
+            for (int i = 0; i < blockCount; i++)
+            {
+                blockSizes[i] = blocks[i].Length;
+                blocks[i].CopyTo(stored, offset);
+                offset += blocks[i].Length;
+            }
+            entry.Stored = stored;
+            entry.BlockCount = blockCount;
+        }
+
+        public void Write(Stream stream)
+        {
+            if (Compress)
+            {
+                foreach (var entry in entries.Where(e => e.Kind == NativeEntryKind.Asset))
+                    CompressEntry(entry);
+            }
+
+            var records = new NativePackFormat.Record[entries.Count];
+            var nameTable = new MemoryStream();
+            for (int i = 0; i < entries.Count; i++)
+            {
+                var entry = entries[i];
+                var name = Encoding.UTF8.GetBytes(entry.Name);
+                records[i] = new NativePackFormat.Record
+                {
+                    hash = AssetName.Hash(entry.Name),
+                    length = entry.Content.Length,
+                    storedLength = entry.Stored?.Length ?? entry.Content.Length,
+                    nameOffset = (int)nameTable.Length,
+                    nameLength = (ushort)name.Length,
+                    kind = entry.Kind,
+                    compression = entry.Stored == null ? NativeCompression.None : NativeCompression.Brotli,
+                    blockCount = entry.BlockCount
+                };
+                nameTable.Write(name);
+            }
+
+            var order = Enumerable.Range(0, entries.Count).OrderBy(i => records[i].hash).ToArray();
+            long offset = NativePackFormat.AlignToPage(NativePackFormat.DirectorySize(entries.Count, (int)nameTable.Length));
+            foreach (var i in order)
+            {
+                records[i].offset = offset;
+                offset = NativePackFormat.AlignToPage(offset + records[i].storedLength);
+            }
+            var sortedRecords = order.Select(i => records[i]).ToArray();
+
+            var header = new NativePackFormat.Header
+            {
+                magic = NativePackFormat.Magic,
+                version = NativePackFormat.Version,
+                entryCount = entries.Count,
+                nameTableSize = (int)nameTable.Length,
+                blockSize = NativePackFormat.BlockSize
+            };
+            long start = stream.Position;
+            stream.Write(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref header, 1)));
+            stream.Write(MemoryMarshal.AsBytes(sourceStamps.AsSpan()));
+            stream.Write(MemoryMarshal.AsBytes(sortedRecords.AsSpan()));
+            stream.Write(nameTable.GetBuffer(), 0, (int)nameTable.Length);
+            foreach (var i in order)
+            {
+                WritePadding(stream, start + records[i].offset);
+                stream.Write(entries[i].Stored ?? entries[i].Content);
+            }
+        }
+
+        private static void WritePadding(Stream stream, long untilPosition)
+        {
+            Span<byte> zeros = stackalloc byte[NativePackFormat.PageSize];
+            while (stream.Position < untilPosition)
+                stream.Write(zeros.Slice(0, (int)Math.Min(zeros.Length, untilPosition - stream.Position)));
+        }
+    }
+}
@@ -0,0 +1,234 @@
+﻿using System;
+using System.Buffers.Binary;
+using System.Collections;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Linq;
+using System.Text;
+
+namespace Aura
+{
+    public readonly struct PackEntry
+    {
+        public string Name { get; }
+        public long Offset { get; }
+        public int Length { get; }
+
+        public PackEntry(string name, long offset, int length)
+        {
+            Name = name;
+            Offset = offset;
+            Length = length;
+        }
+
+        public override string ToString() => $"{Name} ({Length} bytes at {Offset})";
+    }
+
+    /// <summary>The entries of a pack archive together with their lookup table</summary>
+    /// <remarks>Names can be decoded on demand, so a cached directory is usable without touching every name</remarks>
+    internal sealed class PackDirectory : IReadOnlyList<PackEntry>
+    {
+        private readonly IReadOnlyList<string> names;
+        private readonly long[] offsets;
+        private readonly int[] lengths;
+
+        public AssetIndex Index { get; }
+        public int Count => offsets.Length;
+        public PackEntry this[int index] => new PackEntry(names[index], offsets[index], lengths[index]);
+
+        public PackDirectory(IReadOnlyList<string> names, long[] offsets, int[] lengths, AssetIndex index)
+        {
+            this.names = names;
+            this.offsets = offsets;
+            this.lengths = lengths;
+            Index = index;
+        }
+
+        public PackDirectory(PackEntry[] entries)
+        {
+            var entryNames = entries.Select(e => e.Name).ToArray();
+            names = entryNames;
+            offsets = entries.Select(e => e.Offset).ToArray();
+            lengths = entries.Select(e => e.Length).ToArray();
+            Index = new AssetIndex(entryNames);
+        }
+
+        public IEnumerator<PackEntry> GetEnumerator()
+        {
+            for (int i = 0; i < Count; i++)
+                yield return this[i];
+        }
+
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+    }
+
+    public enum PackKind
+    {
+        /// <summary>.psp/.pvd, every entry is a length-prefixed raw file</summary>
+        Assets,
+        /// <summary>.psc, every entry is a line-count-prefixed list of encrypted lines</summary>
+        Scripts
+    }
+
+    /// <summary>Directory of a pack archive, entry contents are only read when opened</summary>
+    public class PackArchive : BaseDisposable, IAssetArchive
+    {
+        private readonly PackDirectory entries;
+        private readonly MemoryMappedFile? mappedFile;
+        private readonly byte[]? memoryContent;
+        private readonly string? filePath;
+
+        public PackKind Kind { get; }
+        public IReadOnlyList<PackEntry> Entries => entries;
+
+        public PackArchive(Stream stream, PackKind kind = PackKind.Assets, PackIndexCache? indexCache = null)
+        {
+            Kind = kind;
+            if (!(stream is FileStream))
+            {
+                // without a file to map we can only hold the whole archive in memory
+                var memoryStream = new MemoryStream();
+                stream.CopyTo(memoryStream);
+                stream.Dispose();
+                memoryContent = memoryStream.GetBuffer();
+                stream = new MemoryStream(memoryContent, 0, (int)memoryStream.Length, writable: false);
+            }
+
+            var fileStream = stream as FileStream;
+            filePath = fileStream?.Name;
+            if (fileStream != null && indexCache != null && indexCache.TryLoad(fileStream, kind, out var cachedEntries))
+                entries = cachedEntries;
+            else
+            {
+                entries = new PackDirectory(ScanEntries(stream, kind));
+                if (fileStream != null)
+                    indexCache?.Store(fileStream, kind, entries);
+            }
+
+            var duplicate = kind == PackKind.Assets ? entries.Index.FindDuplicate() : null;
+            if (duplicate != null)
+                throw new InvalidDataException($"Pack asset {duplicate} was found twice");
+
+            if (memoryContent == null && stream.Length > 0)
+                mappedFile = MemoryMappedFile.CreateFromFile((FileStream)stream, null, 0, MemoryMappedFileAccess.Read, HandleInheritability.None, leaveOpen: false);
+            else
+                stream.Dispose();
+        }
+
+        private static PackEntry[] ScanEntries(Stream stream, PackKind kind)
+        {
+            var packFile = new PackFileReader(stream);
+            var fileNames = packFile.ReadFileList();
+            var entries = new PackEntry[fileNames.Length];
+            for (int i = 0; i < fileNames.Length; i++)
+            {
+                long offset;
+                if (kind == PackKind.Assets)
+                {
+                    int length = (int)packFile.ReadU32();
+                    offset = stream.Position;
+                    if (stream.Seek(length, SeekOrigin.Current) > stream.Length)
+                        throw new InvalidDataException($"Pack entry {fileNames[i]} is out of bounds");
+                }
+                else
+                {
+                    offset = stream.Position;
+                    uint lineCount = packFile.ReadU32();
+                    for (uint j = 0; j < lineCount; j++)
+                    {
+                        if (stream.Seek(packFile.ReadU32(), SeekOrigin.Current) > stream.Length)
+                            throw new InvalidDataException($"Pack entry {fileNames[i]} is out of bounds");
+                    }
+                }
+                entries[i] = new PackEntry(fileNames[i], offset, checked((int)(stream.Position - offset)));
+            }
+            return entries;
+        }
+
+        protected override void DisposeManaged()
+        {
+            // already opened view streams stay valid after the mapping is closed
+            mappedFile?.Dispose();
+        }
+
+        public bool TryFindEntry(ReadOnlySpan<char> name, out PackEntry entry)
+        {
+            int i = entries.Index.IndexOf(name);
+            entry = i < 0 ? default : entries[i];
+            return i >= 0;
+        }
+
+        public bool HasAsset(ReadOnlySpan<char> name) => TryFindEntry(name, out _);
+
+        public Stream? OpenAsset(ReadOnlySpan<char> name) =>
+            TryFindEntry(name, out var entry) ? OpenEntry(entry) : null;
+
+        public bool TryLocateAsset(ReadOnlySpan<char> name, out AssetLocation location)
+        {
+            location = default;
+            if (filePath == null || Kind != PackKind.Assets || !TryFindEntry(name, out var entry))
+                return false;
+            location = new AssetLocation(filePath, entry.Offset, entry.Length);
+            return true;
+        }
+
+        public Stream OpenEntry(PackEntry entry)
+        {
+            if (entry.Length == 0)
+                return new MemoryStream(Array.Empty<byte>(), writable: false);
+            if (mappedFile != null)
+                return mappedFile.CreateViewStream(entry.Offset, entry.Length, MemoryMappedFileAccess.Read);
+            return new MemoryStream(memoryContent!, (int)entry.Offset, entry.Length, writable: false);
+        }
+
+        /// <summary>Decodes the lines of a script entry into a single text</summary>
+        public string ReadScriptText(PackEntry entry) => Encoding.ASCII.GetString(ReadScriptBytes(entry).Span);
+
+        /// <summary>Decodes the lines of a script entry into a single ASCII text</summary>
+        public ReadOnlyMemory<byte> ReadScriptBytes(PackEntry entry)
+        {
+            if (Kind != PackKind.Scripts)
+                throw new InvalidOperationException("Only script packs contain script texts");
+            // every line can at most grow by the line break, the encrypted line length is always larger than that
+            // so the lines are moved to the front of the same buffer
+            var bytes = new byte[entry.Length];
+            using (var stream = OpenEntry(entry))
+                new PackFileReader(stream).ReadRaw(bytes);
+            Span<byte> remaining = bytes;
+            uint lineCount = ReadScriptU32(ref remaining, entry);
+            var newLine = Encoding.ASCII.GetBytes(Environment.NewLine);
+            int textLength = 0;
+            for (uint i = 0; i < lineCount; i++)
+            {
+                int lineLength = (int)ReadScriptU32(ref remaining, entry);
+                if (lineLength < 0 || lineLength > remaining.Length)
+                    throw new InvalidDataException($"Script line in {entry.Name} is out of bounds");
+                var line = remaining.Slice(0, lineLength);
+                remaining = remaining.Slice(lineLength);
+                PackFileReader.Decrypt(line);
+                int nulIndex = line.IndexOf((byte)0);
+                if (nulIndex >= 0)
+                    line = line.Slice(0, nulIndex);
+                line.CopyTo(bytes.AsSpan(textLength));
+                textLength += line.Length;
+                if (line.Length == 0 || line[^1] != '\n')
+                {
+                    newLine.CopyTo(bytes.AsSpan(textLength));
+                    textLength += newLine.Length;
+                }
+            }
+            return bytes.AsMemory(0, textLength);
+        }
+
+        private static uint ReadScriptU32(ref Span<byte> remaining, PackEntry entry)
+        {
+            if (remaining.Length < sizeof(uint))
+                throw new InvalidDataException($"Unexpected end of script {entry.Name}");
+            var word = remaining.Slice(0, sizeof(uint));
+            remaining = remaining.Slice(sizeof(uint));
+            PackFileReader.Decrypt(word);
+            return BinaryPrimitives.ReadUInt32LittleEndian(word);
+        }
+    }
+}
@@ -1,5 +1,9 @@
 ﻿using System;
+using System.Buffers;
+using System.Buffers.Binary;
 using System.IO;
+using System.Numerics;
+using System.Runtime.InteropServices;
 
 namespace Aura
 {
@@ -8,6 +12,8 @@ namespace Aura
         private static readonly uint xorKey = 0x556D6EEC;
         private static readonly byte xorKeyByte = 0xB5;
         private static readonly System.Text.Encoding encoding = System.Text.Encoding.ASCII;
+        private const int StreamChunkSize = 64 * 1024; // has to be a multiple of 4 to keep the key aligned
+        private const int MaxStackStringLength = 256;
 
         private BinaryReader reader;
 
@@ -16,29 +22,101 @@ namespace Aura
             reader = new BinaryReader(stream, encoding, true);
         }
 
+        /// <summary>Decrypts a buffer in-place, the buffer has to start where the encrypted block starts</summary>
+        public static void Decrypt(Span<byte> buffer)
+        {
+            // the archives are little-endian, the reinterpreted words are native-endian
+            uint key = BitConverter.IsLittleEndian ? xorKey : BinaryPrimitives.ReverseEndianness(xorKey);
+            var words = MemoryMarshal.Cast<byte, uint>(buffer);
+            int wordI = 0;
+            if (Vector.IsHardwareAccelerated && words.Length >= Vector<uint>.Count)
+            {
+                var vectors = MemoryMarshal.Cast<uint, Vector<uint>>(words);
+                var keyVector = new Vector<uint>(key);
+                for (int i = 0; i < vectors.Length; i++)
+                    vectors[i] ^= keyVector;
+                wordI = vectors.Length * Vector<uint>.Count;
+            }
+            for (; wordI < words.Length; wordI++)
+                words[wordI] ^= key;
+            for (int i = words.Length * sizeof(uint); i < buffer.Length; i++)
+                buffer[i] ^= xorKeyByte;
+        }
+
         public byte[] ReadRaw(int length) => reader.ReadBytes(length);
 
+        public void ReadRaw(Span<byte> buffer)
+        {
+            while (buffer.Length > 0)
+            {
+                int read = reader.Read(buffer);
+                if (read <= 0)
+                    throw new EndOfStreamException("Unexpected end of pack file");
+                buffer = buffer.Slice(read);
+            }
+        }
+
         public uint ReadU32() => reader.ReadUInt32() ^ xorKey;
 
+        public void ReadBuffer(Span<byte> buffer)
+        {
+            ReadRaw(buffer);
+            Decrypt(buffer);
+        }
+
         public byte[] ReadBuffer(int length)
         {
-            var memStream = new MemoryStream(length);
-            var memWriter = new BinaryWriter(memStream);
-            for (; length >= 4; length -= 4)
-                memWriter.Write(ReadU32());
-            for (; length > 0; length--)
-                memWriter.Write((byte)(reader.ReadByte() ^ xorKeyByte));
-            memWriter.Close();
-            return memStream.ToArray();
+            var buffer = new byte[length];
+            ReadBuffer(buffer);
+            return buffer;
+        }
+
+        /// <summary>Decrypts a large block in chunks without holding all of it in memory</summary>
+        public void ReadBuffer(Stream destination, long length)
+        {
+            var chunk = ArrayPool<byte>.Shared.Rent((int)Math.Min(length, StreamChunkSize));
+            try
+            {
+                while (length > 0)
+                {
+                    var span = chunk.AsSpan(0, (int)Math.Min(length, StreamChunkSize));
+                    ReadBuffer(span); // only the last chunk may have an unaligned tail
+                    destination.Write(span);
+                    length -= span.Length;
+                }
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(chunk);
+            }
+        }
+
+        public static string DecodeString(ReadOnlySpan<byte> buffer)
+        {
+            int length = buffer.IndexOf((byte)0);
+            return encoding.GetString(length < 0 ? buffer : buffer.Slice(0, length));
         }
 
         public string ReadString(int maxLength)
         {
-            var buffer = ReadBuffer(maxLength);
-            int length = Array.IndexOf(buffer, (byte)0);
-            if (length < 0)
-                length = maxLength;
-            return encoding.GetString(buffer, 0, length);
+            if (maxLength <= MaxStackStringLength)
+            {
+                Span<byte> buffer = stackalloc byte[maxLength];
+                ReadBuffer(buffer);
+                return DecodeString(buffer);
+            }
+
+            var rented = ArrayPool<byte>.Shared.Rent(maxLength);
+            try
+            {
+                var buffer = rented.AsSpan(0, maxLength);
+                ReadBuffer(buffer);
+                return DecodeString(buffer);
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(rented);
+            }
         }
 
         public string[] ReadFileList()
@@ -52,4 +130,4 @@ namespace Aura
             return fileNames;
         }
     }
-}
\ No newline at end of file
+}
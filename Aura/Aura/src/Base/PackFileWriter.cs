@@ -0,0 +1,80 @@
+﻿using System;
+using System.Buffers;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+
+namespace Aura
+{
+    /// <summary>Writes the encrypted pack format read by <see cref="PackFileReader"/></summary>
+    public class PackFileWriter
+    {
+        private const int FileNameLength = 128;
+        private static readonly System.Text.Encoding encoding = System.Text.Encoding.ASCII;
+
+        private readonly Stream stream;
+
+        public PackFileWriter(Stream stream)
+        {
+            this.stream = stream;
+        }
+
+        // the encryption is a plain XOR, so it is symmetric to the decryption
+        public static void Encrypt(Span<byte> buffer) => PackFileReader.Decrypt(buffer);
+
+        public void WriteRaw(ReadOnlySpan<byte> buffer) => stream.Write(buffer);
+
+        public void WriteU32(uint value)
+        {
+            Span<byte> buffer = stackalloc byte[sizeof(uint)];
+            BinaryPrimitives.WriteUInt32LittleEndian(buffer, value);
+            WriteBuffer(buffer);
+        }
+
+        /// <summary>Encrypts the buffer in-place and writes it</summary>
+        public void WriteBuffer(Span<byte> buffer)
+        {
+            Encrypt(buffer);
+            stream.Write(buffer);
+        }
+
+        public void WriteString(string value, int length)
+        {
+            if (encoding.GetByteCount(value) >= length)
+                throw new ArgumentException($"String {value} is too long for the pack format");
+            Span<byte> buffer = stackalloc byte[length];
+            buffer.Clear();
+            encoding.GetBytes(value, buffer);
+            WriteBuffer(buffer);
+        }
+
+        public void WriteFileList(IReadOnlyList<string> fileNames)
+        {
+            WriteU32((uint)fileNames.Count);
+            foreach (var fileName in fileNames)
+                WriteString(fileName, FileNameLength);
+        }
+
+        /// <summary>Writes a length-prefixed raw entry of an asset pack</summary>
+        public void WriteAssetEntry(Stream content, int length)
+        {
+            WriteU32((uint)length);
+            var chunk = ArrayPool<byte>.Shared.Rent(64 * 1024);
+            try
+            {
+                while (length > 0)
+                {
+                    int read = content.Read(chunk, 0, Math.Min(length, chunk.Length));
+                    if (read <= 0)
+                        throw new EndOfStreamException("Unexpected end of pack entry content");
+                    stream.Write(chunk, 0, read);
+                    length -= read;
+                }
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(chunk);
+            }
+        }
+    }
+}
@@ -0,0 +1,200 @@
+﻿using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Diagnostics.CodeAnalysis;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace Aura
+{
+    /// <summary>Sidecar files with the decrypted directories of pack archives</summary>
+    /// <remarks>
+    /// An index is keyed by the full archive path and only valid as long as size and
+    /// modification time of the archive do not change. It stores the sorted name hashes of the
+    /// lookup table, so loading it neither decodes nor hashes the names. Failing to read or
+    /// write the cache is never fatal, the archive is scanned instead.
+    /// </remarks>
+    public class PackIndexCache
+    {
+        private const uint Magic = 0x58495041; // APIX
+        private const uint Version = 2;
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        private struct Header
+        {
+            public uint magic;
+            public uint version;
+            public long archiveSize;
+            public long archiveTime;
+            public int kind;
+            public int entryCount;
+            public int nameTableSize;
+            public int pathSize;
+        }
+
+        [StructLayout(LayoutKind.Sequential, Pack = 4)]
+        private struct Record
+        {
+            public long offset;
+            public int length;
+            public int nameOffset;
+            public int nameLength;
+        }
+
+        public string Directory { get; }
+
+        public PackIndexCache(string directory)
+        {
+            Directory = directory;
+        }
+
+        private string GetIndexPath(string archivePath) =>
+            Path.Combine(Directory, $"{AssetName.Hash(archivePath):x16}.pidx");
+
+        /// <summary>Names of a cached directory, decoded only when an entry is looked at</summary>
+        private sealed class NameTable : IReadOnlyList<string>
+        {
+            private readonly byte[] index;
+            private readonly int nameTableStart;
+            private readonly Record[] records;
+            private readonly string?[] names;
+
+            public int Count => records.Length;
+
+            public NameTable(byte[] index, int nameTableStart, Record[] records)
+            {
+                this.index = index;
+                this.nameTableStart = nameTableStart;
+                this.records = records;
+                names = new string?[records.Length];
+            }
+
+            public string this[int i] => names[i] ??=
+                Encoding.ASCII.GetString(index, nameTableStart + records[i].nameOffset, records[i].nameLength);
+
+            public IEnumerator<string> GetEnumerator()
+            {
+                for (int i = 0; i < Count; i++)
+                    yield return this[i];
+            }
+
+            IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+        }
+
+        internal bool TryLoad(FileStream archive, PackKind kind, [NotNullWhen(true)] out PackDirectory? directory)
+        {
+            directory = null;
+            byte[] index;
+            try
+            {
+                index = File.ReadAllBytes(GetIndexPath(archive.Name));
+            }
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                return false;
+            }
+
+            var span = index.AsSpan();
+            if (span.Length < Marshal.SizeOf<Header>())
+                return false;
+            var header = MemoryMarshal.Read<Header>(span);
+            span = span.Slice(Marshal.SizeOf<Header>());
+            long recordsSize = (long)header.entryCount * Marshal.SizeOf<Record>();
+            long hashesSize = (long)header.entryCount * (sizeof(ulong) + sizeof(int));
+            if (header.magic != Magic ||
+                header.version != Version ||
+                header.kind != (int)kind ||
+                header.archiveSize != archive.Length ||
+                header.archiveTime != File.GetLastWriteTimeUtc(archive.Name).Ticks ||
+                header.entryCount < 0 || header.nameTableSize < 0 || header.pathSize < 0 ||
+                span.Length != header.pathSize + recordsSize + hashesSize + header.nameTableSize)
+                return false;
+
+            if (Encoding.UTF8.GetString(span.Slice(0, header.pathSize)) != archive.Name)
+                return false; // hash collision of two archive paths
+            span = span.Slice(header.pathSize);
+            var records = MemoryMarshal.Cast<byte, Record>(span.Slice(0, (int)recordsSize)).ToArray();
+            span = span.Slice((int)recordsSize);
+            var sortedHashes = MemoryMarshal.Cast<byte, ulong>(span.Slice(0, header.entryCount * sizeof(ulong))).ToArray();
+            var sortedIndices = MemoryMarshal.Cast<byte, int>(span.Slice(header.entryCount * sizeof(ulong), header.entryCount * sizeof(int))).ToArray();
+
+            var offsets = new long[records.Length];
+            var lengths = new int[records.Length];
+            var isIndexed = new bool[records.Length];
+            for (int i = 0; i < records.Length; i++)
+            {
+                var record = records[i];
+                if (record.nameOffset < 0 || record.nameLength < 0 || record.nameOffset > header.nameTableSize - record.nameLength)
+                    return false;
+                if (record.offset < 0 || record.length < 0 || record.offset > archive.Length - record.length)
+                    return false; // e.g. the archive was truncated without changing its modification time
+                if (i > 0 && sortedHashes[i] < sortedHashes[i - 1])
+                    return false;
+                int sortedIndex = sortedIndices[i];
+                if (sortedIndex < 0 || sortedIndex >= records.Length || isIndexed[sortedIndex])
+                    return false;
+                isIndexed[sortedIndex] = true;
+                offsets[i] = record.offset;
+                lengths[i] = record.length;
+            }
+
+            var names = new NameTable(index, index.Length - header.nameTableSize, records);
+            directory = new PackDirectory(names, offsets, lengths, new AssetIndex(names, sortedHashes, sortedIndices));
+            return true;
+        }
+
+        internal void Store(FileStream archive, PackKind kind, PackDirectory entries)
+        {
+            var records = new Record[entries.Count];
+            var nameTable = new MemoryStream();
+            for (int i = 0; i < entries.Count; i++)
+            {
+                var entry = entries[i];
+                var name = Encoding.ASCII.GetBytes(entry.Name);
+                records[i] = new Record
+                {
+                    offset = entry.Offset,
+                    length = entry.Length,
+                    nameOffset = (int)nameTable.Length,
+                    nameLength = name.Length
+                };
+                nameTable.Write(name);
+            }
+            var path = Encoding.UTF8.GetBytes(archive.Name);
+            var header = new Header
+            {
+                magic = Magic,
+                version = Version,
+                archiveSize = archive.Length,
+                archiveTime = File.GetLastWriteTimeUtc(archive.Name).Ticks,
+                kind = (int)kind,
+                entryCount = entries.Count,
+                nameTableSize = (int)nameTable.Length,
+                pathSize = path.Length
+            };
+
+            var indexPath = GetIndexPath(archive.Name);
+            var tempPath = $"{indexPath}.{Environment.ProcessId}.tmp";
+            try
+            {
+                System.IO.Directory.CreateDirectory(Directory);
+                using (var stream = new FileStream(tempPath, FileMode.Create, FileAccess.Write))
+                {
+                    stream.Write(MemoryMarshal.AsBytes(MemoryMarshal.CreateReadOnlySpan(ref header, 1)));
+                    stream.Write(path);
+                    stream.Write(MemoryMarshal.AsBytes(records.AsSpan()));
+                    stream.Write(MemoryMarshal.AsBytes(entries.Index.SortedHashes));
+                    stream.Write(MemoryMarshal.AsBytes(entries.Index.SortedIndices));
+                    stream.Write(nameTable.GetBuffer(), 0, (int)nameTable.Length);
+                }
+                File.Move(tempPath, indexPath, overwrite: true);
+            }
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                Console.WriteLine($"Warning: Could not write pack index for {archive.Name}: {e.Message}");
+                try { File.Delete(tempPath); } catch (IOException) { }
+            }
+        }
+    }
+}
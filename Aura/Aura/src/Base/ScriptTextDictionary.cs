@@ -0,0 +1,39 @@
+﻿using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+
+namespace Aura
+{
+    /// <summary>Read-only dictionary of ASCII script texts which are only decoded on first access</summary>
+    public class ScriptTextDictionary : IReadOnlyDictionary<string, ReadOnlyMemory<byte>>
+    {
+        private readonly Dictionary<string, Lazy<ReadOnlyMemory<byte>>> texts;
+
+        public ScriptTextDictionary(IEnumerable<string> names, Func<string, ReadOnlyMemory<byte>> decodeText)
+        {
+            texts = names.ToDictionary(
+                name => name,
+                name => new Lazy<ReadOnlyMemory<byte>>(() => decodeText(name), LazyThreadSafetyMode.ExecutionAndPublication));
+        }
+
+        public ReadOnlyMemory<byte> this[string key] => texts[key].Value;
+        public IEnumerable<string> Keys => texts.Keys;
+        public IEnumerable<ReadOnlyMemory<byte>> Values => texts.Values.Select(t => t.Value);
+        public int Count => texts.Count;
+
+        public bool ContainsKey(string key) => texts.ContainsKey(key);
+
+        public bool TryGetValue(string key, out ReadOnlyMemory<byte> value)
+        {
+            var found = texts.TryGetValue(key, out var text);
+            value = found ? text!.Value : default;
+            return found;
+        }
+
+        public IEnumerator<KeyValuePair<string, ReadOnlyMemory<byte>>> GetEnumerator() =>
+            texts.Select(p => new KeyValuePair<string, ReadOnlyMemory<byte>>(p.Key, p.Value.Value)).GetEnumerator();
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+    }
+}
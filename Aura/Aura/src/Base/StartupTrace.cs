@@ -0,0 +1,73 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+
+namespace Aura
+{
+    public readonly struct StartupStep
+    {
+        public TimeSpan Start { get; }
+        public TimeSpan Duration { get; }
+        public int ThreadId { get; }
+        public string Name { get; }
+
+        public StartupStep(TimeSpan start, TimeSpan duration, int threadId, string name)
+        {
+            Start = start;
+            Duration = duration;
+            ThreadId = threadId;
+            Name = name;
+        }
+
+        public override string ToString() =>
+            $"{Start.TotalMilliseconds.ToString("F3", CultureInfo.InvariantCulture)}\t{Duration.TotalMilliseconds.ToString("F3", CultureInfo.InvariantCulture)}\t{ThreadId}\t{Name}";
+    }
+
+    /// <summary>Records the timings of the engine startup steps</summary>
+    /// <remarks>Traces are tab-separated text with one step per line: start milliseconds, duration milliseconds, thread id, name</remarks>
+    public class StartupTrace
+    {
+        private readonly object stepsLock = new object();
+        private readonly Stopwatch stopwatch = Stopwatch.StartNew();
+        private readonly List<StartupStep> steps = new List<StartupStep>();
+
+        public IReadOnlyList<StartupStep> Steps
+        {
+            get
+            {
+                lock (stepsLock)
+                    return steps.ToArray();
+            }
+        }
+
+        public void Measure(string name, Action action) => Measure(name, () =>
+        {
+            action();
+            return true;
+        });
+
+        public T Measure<T>(string name, Func<T> func)
+        {
+            var start = stopwatch.Elapsed;
+            try
+            {
+                return func();
+            }
+            finally
+            {
+                var step = new StartupStep(start, stopwatch.Elapsed - start, Environment.CurrentManagedThreadId, name);
+                lock (stepsLock)
+                    steps.Add(step);
+            }
+        }
+
+        public void Write(TextWriter writer)
+        {
+            foreach (var step in Steps.OrderBy(s => s.Start))
+                writer.WriteLine(step.ToString());
+        }
+    }
+}
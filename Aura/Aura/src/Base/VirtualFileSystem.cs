@@ -0,0 +1,300 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.Win32.SafeHandles;
+
+namespace Aura
+{
+    /// <summary>Resolves asset paths through a stack of mounted archives, later mounts take precedence</summary>
+    /// <remarks>
+    /// Paths are matched case-insensitively and with either slash as separator. Lookups do not
+    /// allocate beyond the stream that is returned.
+    /// </remarks>
+    public class VirtualFileSystem : BaseDisposable
+    {
+        private const int MaxStackPathLength = 512;
+
+        private class MountPoint : IDisposable
+        {
+            public VirtualFileSystem FileSystem = null!;
+            public string Prefix = "";
+            public IAssetArchive Archive = null!;
+            public bool OwnsArchive;
+
+            public void Dispose() => FileSystem.Unmount(this);
+        }
+
+        private readonly object mountLock = new object();
+        private MountPoint[] mounts = Array.Empty<MountPoint>(); // replaced on change so lookups can use a snapshot
+
+        /// <summary>Records all successfully opened or read assets if set, the tracer is not owned</summary>
+        public AssetAccessTracer? Tracer { get; set; }
+
+        protected override void DisposeManaged()
+        {
+            var oldMounts = mounts;
+            mounts = Array.Empty<MountPoint>();
+            foreach (var mount in oldMounts.Where(m => m.OwnsArchive))
+                mount.Archive.Dispose();
+        }
+
+        /// <summary>Mounts an archive at a directory prefix like "Scenes/Ship/", dispose the result to unmount</summary>
+        public IDisposable Mount(string prefix, IAssetArchive archive, bool ownsArchive = true)
+        {
+            prefix = prefix.Replace('\\', '/');
+            if (prefix.Length > 0 && !prefix.EndsWith("/"))
+                prefix += "/";
+            var mount = new MountPoint
+            {
+                FileSystem = this,
+                Prefix = prefix,
+                Archive = archive,
+                OwnsArchive = ownsArchive
+            };
+            lock (mountLock)
+                mounts = mounts.Append(mount).ToArray();
+            return mount;
+        }
+
+        private void Unmount(MountPoint mount)
+        {
+            lock (mountLock)
+            {
+                if (!mounts.Contains(mount))
+                    return;
+                mounts = mounts.Where(m => m != mount).ToArray();
+            }
+            if (mount.OwnsArchive)
+                mount.Archive.Dispose();
+        }
+
+        /// <summary>Mounts the loose files of the game directory and the global asset packs</summary>
+        public void MountGameDirectory(string path)
+        {
+            Mount("", new LooseFileArchive(path));
+            var globalPath = Path.Combine(path, "Global");
+            if (!Directory.Exists(globalPath))
+                return;
+            foreach (var packPath in Directory.EnumerateFiles(globalPath).Where(IsAssetPack).OrderBy(p => p))
+            {
+                var stream = new FileStream(packPath, FileMode.Open, FileAccess.Read);
+                IAssetArchive archive = Path.GetExtension(packPath).ToLowerInvariant() == ".anp"
+                    ? new NativePackArchive(stream)
+                    : new PackArchive(stream);
+                Mount("Global/", archive);
+            }
+        }
+
+        private static bool IsAssetPack(string path)
+        {
+            var extension = Path.GetExtension(path).ToLowerInvariant();
+            return extension == ".psp" || extension == ".pvd" || extension == ".anp";
+        }
+
+        private static ReadOnlySpan<char> TrimCurrentDirectory(ReadOnlySpan<char> path) =>
+            path.StartsWith(".\\") || path.StartsWith("./") ? path.Slice(2) : path;
+
+        private static bool TryStripPrefix(ReadOnlySpan<char> path, string prefix, out ReadOnlySpan<char> rest)
+        {
+            rest = path;
+            if (path.Length < prefix.Length || !AssetName.Equals(path.Slice(0, prefix.Length), prefix))
+                return false;
+            rest = path.Slice(prefix.Length);
+            return true;
+        }
+
+        public bool HasAsset(ReadOnlySpan<char> path)
+        {
+            path = TrimCurrentDirectory(path);
+            var currentMounts = mounts;
+            for (int i = currentMounts.Length - 1; i >= 0; i--)
+            {
+                if (TryStripPrefix(path, currentMounts[i].Prefix, out var rest) && currentMounts[i].Archive.HasAsset(rest))
+                    return true;
+            }
+            return false;
+        }
+
+        public Stream? OpenAsset(ReadOnlySpan<char> path)
+        {
+            path = TrimCurrentDirectory(path);
+            var stream = OpenAssetUntraced(path);
+            if (stream != null)
+                Tracer?.Record(path);
+            return stream;
+        }
+
+        private Stream? OpenAssetUntraced(ReadOnlySpan<char> path)
+        {
+            var currentMounts = mounts;
+            for (int i = currentMounts.Length - 1; i >= 0; i--)
+            {
+                if (!TryStripPrefix(path, currentMounts[i].Prefix, out var rest))
+                    continue;
+                var stream = currentMounts[i].Archive.OpenAsset(rest);
+                if (stream != null)
+                    return stream;
+            }
+            return null;
+        }
+
+        /// <summary>Opens an asset relative to a directory without concatenating the path on the heap</summary>
+        public Stream? OpenAsset(ReadOnlySpan<char> directory, ReadOnlySpan<char> name)
+        {
+            name = TrimCurrentDirectory(name);
+            int length = directory.Length + name.Length;
+            Span<char> path = length <= MaxStackPathLength ? stackalloc char[length] : new char[length];
+            directory.CopyTo(path);
+            name.CopyTo(path.Slice(directory.Length));
+            return OpenAsset(path);
+        }
+
+        public bool TryLocateAsset(ReadOnlySpan<char> path, out AssetLocation location)
+        {
+            path = TrimCurrentDirectory(path);
+            var currentMounts = mounts;
+            for (int i = currentMounts.Length - 1; i >= 0; i--)
+            {
+                if (TryStripPrefix(path, currentMounts[i].Prefix, out var rest) && currentMounts[i].Archive.HasAsset(rest))
+                    return currentMounts[i].Archive.TryLocateAsset(rest, out location);
+            }
+            location = default;
+            return false;
+        }
+
+        /// <summary>Reads a batch of assets concurrently into pooled buffers, missing assets result in null</summary>
+        /// <remarks>
+        /// Assets which are not stored as-is in a file (e.g. compressed) are read through their archive on the thread pool.
+        /// An asset that fails to be read results in a faulted <see cref="AssetBuffer"/>, the other assets of the batch are unaffected.
+        /// </remarks>
+        public async ValueTask<AssetBuffer?[]> ReadAssetsAsync(IReadOnlyList<AssetReadRequest> requests, CancellationToken cancellationToken = default)
+        {
+            var results = new AssetBuffer?[requests.Count];
+            var tasks = new List<Task>(requests.Count);
+            var handles = new Dictionary<string, SafeFileHandle>();
+            async Task ReadInto(int requestI, SafeFileHandle handle, AssetLocation location)
+            {
+                try
+                {
+                    results[requestI] = await ReadLocatedAsync(handle, location, requests[requestI], cancellationToken).ConfigureAwait(false);
+                }
+                catch (Exception e) when (!(e is OperationCanceledException))
+                {
+                    results[requestI] = AssetBuffer.FromError(e);
+                }
+            }
+            AssetBuffer? ReadThroughArchiveOrFault(AssetReadRequest request)
+            {
+                try
+                {
+                    return ReadThroughArchive(request);
+                }
+                catch (Exception e) when (!(e is OperationCanceledException))
+                {
+                    return AssetBuffer.FromError(e);
+                }
+            }
+            try
+            {
+                for (int i = 0; i < requests.Count; i++)
+                {
+                    int requestI = i;
+                    var request = requests[i];
+                    var handle = TryLocateAsset(request.Path, out var location)
+                        ? OpenHandle(handles, location.FilePath)
+                        : null;
+                    if (handle != null)
+                        tasks.Add(ReadInto(requestI, handle, location));
+                    else
+                        tasks.Add(Task.Run(() => results[requestI] = ReadThroughArchiveOrFault(request), cancellationToken));
+                }
+                await Task.WhenAll(tasks).ConfigureAwait(false);
+                for (int i = 0; i < requests.Count; i++)
+                {
+                    if (results[i]?.IsFaulted == false)
+                        Tracer?.Record(requests[i].Path);
+                }
+            }
+            catch
+            {
+                await Task.WhenAll(tasks.Select(t => t.ContinueWith(_ => { }, TaskScheduler.Default))).ConfigureAwait(false);
+                foreach (var result in results)
+                    result?.Dispose();
+                throw;
+            }
+            finally
+            {
+                foreach (var handle in handles.Values)
+                    handle.Dispose();
+            }
+            return results;
+        }
+
+        private static SafeFileHandle? OpenHandle(Dictionary<string, SafeFileHandle> handles, string filePath)
+        {
+            if (handles.TryGetValue(filePath, out var handle))
+                return handle;
+            try
+            {
+                handle = File.OpenHandle(filePath, FileMode.Open, FileAccess.Read, FileShare.Read, FileOptions.Asynchronous);
+            }
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                return null; // read through the archive instead, which reports the error for this asset only
+            }
+            handles.Add(filePath, handle);
+            return handle;
+        }
+
+        private static async Task<AssetBuffer> ReadLocatedAsync(SafeFileHandle handle, AssetLocation location, AssetReadRequest request, CancellationToken cancellationToken)
+        {
+            long assetLength = location.Length ?? (RandomAccess.GetLength(handle) - location.Offset);
+            long offset = location.Offset + Math.Min(request.Offset, assetLength);
+            long available = assetLength - Math.Min(request.Offset, assetLength);
+            var buffer = new AssetBuffer((int)Math.Min(request.Length ?? available, available));
+            try
+            {
+                var memory = buffer.WritableMemory;
+                while (memory.Length > 0)
+                {
+                    int read = await RandomAccess.ReadAsync(handle, memory, offset, cancellationToken).ConfigureAwait(false);
+                    if (read <= 0)
+                        throw new EndOfStreamException($"Unexpected end of file while reading {request.Path}");
+                    memory = memory.Slice(read);
+                    offset += read;
+                }
+                return buffer;
+            }
+            catch
+            {
+                buffer.Dispose();
+                throw;
+            }
+        }
+
+        private AssetBuffer? ReadThroughArchive(AssetReadRequest request)
+        {
+            using var stream = OpenAssetUntraced(TrimCurrentDirectory(request.Path));
+            if (stream == null)
+                return null;
+            long available = Math.Max(0, stream.Length - request.Offset);
+            stream.Position = Math.Min(request.Offset, stream.Length);
+            var buffer = new AssetBuffer((int)Math.Min(request.Length ?? available, available));
+            var span = buffer.WritableMemory.Span;
+            while (span.Length > 0)
+            {
+                int read = stream.Read(span);
+                if (read <= 0)
+                {
+                    buffer.Dispose();
+                    throw new EndOfStreamException($"Unexpected end of asset while reading {request.Path}");
+                }
+                span = span.Slice(read);
+            }
+            return buffer;
+        }
+    }
+}
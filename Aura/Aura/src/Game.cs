@@ -3,18 +3,52 @@ using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Numerics;
+using System.Threading.Tasks;
 using Aura.Script;
 using Aura.Systems;
 
 namespace Aura
 {
-    public class Game : BaseDisposable, IGameSystemContainer
+    public partial class Game : BaseDisposable, IGameSystemContainer
     {
+        /// <summary>A scene that was loaded in the background but is not shown yet</summary>
+        private class PreparedScene : BaseDisposable
+        {
+            public LoadSceneContext Context { get; }
+            public Vector2? ViewAt { get; }
+            public List<(IGraphicListSystem system, Interpreter interpreter, FunctionCallNode[] calls, object?[][] arguments)> GraphicLists { get; } =
+                new List<(IGraphicListSystem system, Interpreter interpreter, FunctionCallNode[] calls, object?[][] arguments)>();
+
+            public PreparedScene(LoadSceneContext context, Vector2? viewAt)
+            {
+                Context = context;
+                ViewAt = viewAt;
+            }
+
+            protected override void DisposeManaged()
+            {
+                var mappedArguments = GraphicLists.SelectMany(l => l.arguments).Where(a => a != null).SelectMany(a => a);
+                foreach (var argument in mappedArguments.OfType<IDisposable>())
+                    argument.Dispose();
+                Context.Dispose();
+            }
+        }
+
         private IGameSystem[] systems;
         private Interpreter gameInterpreter;
-        private Action? onNextUpdate = null;
+        private Task<PreparedScene>? pendingScene = null;
+        private LoadSceneContext? currentContext = null;
+        private SceneCache sceneCache = new SceneCache();
+        private Task? deferredInitialization = null;
+        private int updateCount = 0;
 
         public IBackend Backend { get; }
+        public SceneCache SceneCache => sceneCache;
+        /// <summary>Measures the phases of scenes loaded from now on if set</summary>
+        public LoadProfiler? LoadProfiler { get; set; }
+        public StartupTrace StartupTrace { get; } = new StartupTrace();
+        /// <summary>Whether the deferred system initialization has completed as well</summary>
+        public bool IsInitialized => deferredInitialization?.IsCompletedSuccessfully == true;
         public IReadOnlyCollection<IGameSystem> Systems => systems;
         public IEnumerable<T> SystemsWith<T>() where T : IGameSystem => systems.OfType<T>();
 
@@ -22,7 +56,7 @@ namespace Aura
         {
             Backend = backend;
             gameInterpreter = new Interpreter();
-            systems = new IGameSystem[]
+            systems = StartupTrace.Measure("Construct systems", () => new IGameSystem[]
             {
                 new GameWorldRendererSystem(Backend),
                 new GlobalsSystem(Backend),
@@ -33,102 +67,231 @@ namespace Aura
                 new CellSystem(),
                 new CursorSystem(),
                 new FullScreenVideoSystem(),
+                new ScenePrefetchSystem(),
                 new DummyScriptSystem()
-            }.Concat(backendSystems).ToArray();
-            foreach (var system in Systems)
-                system.CrossInitialize(this);
-            foreach (var vsSystem in SystemsWith<IGameVariableSet>())
-                gameInterpreter.RegisterVariableSet(vsSystem.VariableSetName, vsSystem);
-            foreach (var fSystem in Systems)
+            }.Concat(backendSystems).ToArray());
+            StartupTrace.Measure("Cross-initialize systems", () =>
             {
-                gameInterpreter.RegisterAllFunctionsIn(fSystem);
-                fSystem.RegisterGameFunctions(gameInterpreter);
-            }
-            gameInterpreter.RegisterAllFunctionsIn(this);
+                foreach (var system in Systems)
+                    system.CrossInitialize(this);
+            });
+            var initialization = InitializeSystems(systems.Where(s => !s.IsInitializationDeferred).ToArray());
+            StartupTrace.Measure("Register functions", () =>
+            {
+                foreach (var vsSystem in SystemsWith<IGameVariableSet>())
+                    gameInterpreter.RegisterVariableSet(vsSystem.VariableSetName, vsSystem);
+                foreach (var fSystem in Systems)
+                {
+                    gameInterpreter.RegisterAllFunctionsIn(fSystem);
+                    fSystem.RegisterGameFunctions(gameInterpreter);
+                }
+                gameInterpreter.RegisterAllFunctionsIn(this);
+            });
+            StartupTrace.Measure("Wait for initialization", () => initialization.GetAwaiter().GetResult());
 
-            LoadScene("010", SceneType.Panorama);
+            StartupTrace.Measure("Load scene 010", () => ApplyScene(PrepareScene("010", SceneType.Panorama, null)));
         }
 
         protected override void DisposeManaged()
         {
+            try
+            {
+                deferredInitialization?.Wait();
+            }
+            catch (AggregateException) { } // was already reported by Update
+            DiscardPendingScene()?.Wait();
             foreach (var system in Systems)
                 system.Dispose();
+            currentContext?.Dispose();
+            sceneCache.Dispose();
         }
 
+        /// <summary>Initializes the systems concurrently on the thread pool</summary>
+        private Task InitializeSystems(IEnumerable<IGameSystem> toInitialize) => Task.WhenAll(toInitialize.Select(system =>
+            Task.Run(() => StartupTrace.Measure($"Initialize {system.GetType().Name}", system.Initialize))));
+
         public void Update(float timeDelta)
         {
+            if (deferredInitialization == null && ++updateCount > 1) // the first frame was shown
+                deferredInitialization = InitializeSystems(systems.Where(s => s.IsInitializationDeferred).ToArray());
+            else if (deferredInitialization?.IsFaulted == true)
+                deferredInitialization.GetAwaiter().GetResult(); // rethrows initialization errors on the main thread
+
             foreach (var ptSystem in Systems)
                 ptSystem.Update(timeDelta);
             gameInterpreter.Continue();
-            onNextUpdate?.Invoke();
-            onNextUpdate = null;
+            if (pendingScene?.IsCompleted == true)
+            {
+                var preparedScene = pendingScene.GetAwaiter().GetResult(); // rethrows loading errors on the main thread
+                pendingScene = null;
+                ApplyScene(preparedScene);
+            }
         }
 
         [ScriptFunction]
         [ScriptFunction("LoadScene")]
         private void ScrLoadSceneTransfuse(string sceneName, int startPosX, int startPosY)
         {
-            onNextUpdate += () =>
-            {
-                LoadScene(sceneName, SceneType.Panorama);
-                SystemsWith<GameWorldRendererSystem>().Single().WorldRenderer?.SetViewAt(new Vector2(startPosX, startPosY));
-            };
+            BeginLoadScene(sceneName, SceneType.Panorama, new Vector2(startPosX, startPosY));
             gameInterpreter.CancelCurrentExecution();
         }
 
         [ScriptFunction]
         private void ScrLoadPuzzleTransfuse(string puzzleName)
         {
-            onNextUpdate += () =>
-            {
-                LoadScene(puzzleName, SceneType.Puzzle);
-            };
+            BeginLoadScene(puzzleName, SceneType.Puzzle, null);
             gameInterpreter.CancelCurrentExecution();
         }
 
-        private void LoadScene(string sceneName, SceneType type)
+        /// <summary>Loads and applies a scene on the calling thread, a pending scene load is discarded</summary>
+        public void LoadScene(string sceneName, SceneType type, Vector2? viewAt = null)
+        {
+            DiscardPendingScene()?.Wait();
+            ApplyScene(PrepareScene(sceneName, type, viewAt, TakeRetainedOrPrefetched(sceneName, type)));
+        }
+
+        /// <summary>Loads a scene on the thread pool, the current scene keeps running until the new one is swapped in by <see cref="Update(float)"/></summary>
+        private void BeginLoadScene(string sceneName, SceneType type, Vector2? viewAt)
+        {
+            DiscardPendingScene();
+            var prefetched = TakeRetainedOrPrefetched(sceneName, type);
+            pendingScene = Task.Run(() => PrepareScene(sceneName, type, viewAt, prefetched));
+        }
+
+        private Task<LoadSceneContext>? TakeRetainedOrPrefetched(string sceneName, SceneType type)
+        {
+            var retained = sceneCache.Take(sceneName, type);
+            var prefetched = SystemsWith<ScenePrefetchSystem>().SingleOrDefault()?.Take(sceneName, type);
+            if (retained == null)
+                return prefetched;
+            prefetched?.ContinueWith(t => t.Result.Dispose(), TaskContinuationOptions.OnlyOnRanToCompletion);
+            return Task.FromResult(retained);
+        }
+
+        private Task? DiscardPendingScene()
+        {
+            var discarded = pendingScene?.ContinueWith(t =>
+            {
+                if (t.IsCompletedSuccessfully)
+                    t.Result.Dispose();
+                else if (t.Exception != null)
+                    Console.WriteLine($"Discarded scene failed to load: {t.Exception.InnerException?.Message}");
+            }, TaskScheduler.Default);
+            pendingScene = null;
+            return discarded;
+        }
+
+        private static LoadSceneContext? TakePrefetched(Task<LoadSceneContext>? prefetched)
+        {
+            try
+            {
+                return prefetched?.GetAwaiter().GetResult();
+            }
+            catch (Exception)
+            {
+                return null; // loading the scene again will report the error
+            }
+        }
+
+        private PreparedScene PrepareScene(string sceneName, SceneType type, Vector2? viewAt, Task<LoadSceneContext>? prefetched = null)
         {
             Console.WriteLine($"Loading scene \"{sceneName}\"");
-            var context = new LoadSceneContext(Backend, sceneName, type);
+            var context = TakePrefetched(prefetched) ?? new LoadSceneContext(Backend, sceneName, type, LoadProfiler);
+            var preparedScene = new PreparedScene(context, viewAt);
+            try
+            {
+                foreach (var system in Systems)
+                    system.PrepareScene(context);
+                context.Syntax.Trim(); // all scripts of the scene are parsed by now
+
+                var graphicListSystems = SystemsWith<IGraphicListSystem>();
+                var graphicListInterpreter = new Interpreter();
+                graphicListInterpreter.RegisterArgumentMapper(typeof(ITexture), typeof(StringNode), context.ScrArgLoadImage);
+                graphicListInterpreter.RegisterArgumentMapper(typeof(IVideoTexture), typeof(StringNode), context.ScrArgLoadVideo);
+                foreach (var glSystem in graphicListSystems)
+                {
+                    if (!context.Scene.EntityLists.TryGetValue(glSystem.GraphicListName, out var entityList))
+                        continue;
+                    if (!(entityList is GraphicListNode))
+                        throw new InvalidDataException($"{entityList.Position}: Expected {entityList.Name} to be a graphic list");
+                    var graphicList = (GraphicListNode)entityList;
+
+                    // the load functions only capture the system, they are not called before the scene is applied
+                    var curGLInterpreter = graphicListInterpreter.Clone();
+                    glSystem.RegisterLoadFunctions(context, curGLInterpreter);
+                    var calls = graphicList.Graphics.Values.Select(g => g.Value).ToArray();
+                    preparedScene.GraphicLists.Add((glSystem, curGLInterpreter, calls, new object?[calls.Length][]));
+                }
+
+                // load all referenced assets at once so the argument mapping below only picks them up
+                using var graphicAssetScope = LoadProfiler.Measure(LoadProfiler, LoadPhase.GraphicAssets);
+                var graphicCalls = preparedScene.GraphicLists.SelectMany(l => l.calls.Select(call => (l.interpreter, call))).ToArray();
+                context.PreloadGraphics(
+                    graphicCalls.SelectMany(c => c.interpreter.FindArgumentsOfType(c.call, typeof(ITexture))).OfType<StringNode>(),
+                    graphicCalls.SelectMany(c => c.interpreter.FindArgumentsOfType(c.call, typeof(IVideoTexture))).OfType<StringNode>());
+                foreach (var (_, interpreter, calls, arguments) in preparedScene.GraphicLists)
+                {
+                    for (int i = 0; i < calls.Length; i++)
+                        arguments[i] = interpreter.MapArguments(calls[i]);
+                }
+                return preparedScene;
+            }
+            catch
+            {
+                preparedScene.Dispose();
+                throw;
+            }
+        }
+
+        private void ApplyScene(PreparedScene preparedScene)
+        {
+            var context = preparedScene.Context;
             foreach (var evSystem in Systems)
                 evSystem.OnBeforeSceneChange(context);
 
-            var graphicListSystems = SystemsWith<IGraphicListSystem>();
-            var graphicListInterpreter = new Interpreter();
-            graphicListInterpreter.RegisterArgumentMapper(typeof(ITexture), typeof(StringNode), context.ScrArgLoadImage);
-            graphicListInterpreter.RegisterArgumentMapper(typeof(IVideoTexture), typeof(StringNode), context.ScrArgLoadVideo);
-            foreach (var glSystem in graphicListSystems)
+            var graphicLists = preparedScene.GraphicLists.ToArray();
+            preparedScene.GraphicLists.Clear(); // the systems own the loaded assets from now on
+            using (LoadProfiler.Measure(LoadProfiler, LoadPhase.GraphicLists))
             {
-                if (!context.Scene.EntityLists.TryGetValue(glSystem.GraphicListName, out var entityList))
-                    continue;
-                if (!(entityList is GraphicListNode))
-                    throw new InvalidDataException($"{entityList.Position}: Expected {entityList.Name} to be a graphic list");
-                var graphicList = (GraphicListNode)entityList;
-
-                var curGLInterpreter = graphicListInterpreter.Clone();
-                glSystem.RegisterLoadFunctions(context, curGLInterpreter);
-                glSystem.GraphicCount = graphicList.Graphics.Count;
-                foreach (var graphic in graphicList.Graphics.Values)
-                    curGLInterpreter.ExecuteSync(graphic.Value);
+                foreach (var (glSystem, interpreter, calls, arguments) in graphicLists)
+                {
+                    glSystem.GraphicCount = calls.Length;
+                    for (int i = 0; i < calls.Length; i++)
+                        interpreter.ExecuteSync(calls[i], arguments[i]);
+                }
             }
 
             var objectListSystems = SystemsWith<IObjectListSystem>();
-            foreach (var olSystem in objectListSystems)
+            using (LoadProfiler.Measure(LoadProfiler, LoadPhase.ObjectLists))
             {
-                if (!context.Scene.EntityLists.TryGetValue(olSystem.ObjectListName, out var entityList))
-                    continue;
-                if (!(entityList is ObjectListNode))
-                    throw new InvalidDataException($"{entityList.Position}: Expected {entityList.Name} to be an object list");
-                var objectList = (ObjectListNode)entityList;
-
-                foreach (var obj in objectList.Objects.Values)
-                    olSystem.AddObject(context, obj);
+                foreach (var olSystem in objectListSystems)
+                {
+                    if (!context.Scene.EntityLists.TryGetValue(olSystem.ObjectListName, out var entityList))
+                        continue;
+                    if (!(entityList is ObjectListNode))
+                        throw new InvalidDataException($"{entityList.Position}: Expected {entityList.Name} to be an object list");
+                    var objectList = (ObjectListNode)entityList;
+
+                    foreach (var obj in objectList.Objects.Values)
+                        olSystem.AddObject(context, obj);
+                }
             }
+            context.SyntaxCache?.Save(); // only now, adding the objects may still parse or request cell scripts
 
             foreach (var evSystem in Systems)
                 evSystem.OnAfterSceneChange();
+            if (currentContext != null)
+                sceneCache.Retain(currentContext); // the previous scene is kept until it exceeds the budget
+            currentContext = context;
+            if (Backend.FileSystem.Tracer != null)
+                Backend.FileSystem.Tracer.CurrentScene = context.SceneName;
             if (context.Scene.Events.TryGetValue("@OnLoadScene", out var onLoadEvent))
+            {
+                using var onLoadScope = LoadProfiler.Measure(LoadProfiler, LoadPhase.OnLoadScene);
                 gameInterpreter.ExecuteSync(onLoadEvent.Action);
+            }
+            if (preparedScene.ViewAt != null)
+                SystemsWith<GameWorldRendererSystem>().Single().WorldRenderer?.SetViewAt(preparedScene.ViewAt.Value);
         }
     }
 }
@@ -1,8 +1,11 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Numerics;
 using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
 
 namespace Aura
 {
@@ -38,6 +41,8 @@ namespace Aura
         Vector2 ViewportSize { get; set; }
         bool IsActive { get; set; }
         int Order { get; set; }
+        /// <summary>Approximate size of the GPU resources, used to budget retained scenes</summary>
+        long MemorySize { get; }
         IReadOnlyList<IWorldSprite> Sprites { get; }
 
         bool ConvertScreenToWorld(Vector2 screenPos, out Vector2 worldPos);
@@ -57,9 +62,17 @@ namespace Aura
 
     public interface IBackend
     {
-        Stream? OpenAssetFile(string resourceName);
+        VirtualFileSystem FileSystem { get; }
+        Stream? OpenAssetFile(string resourceName) => FileSystem.OpenAsset(resourceName);
+        ValueTask<AssetBuffer?[]> ReadAssetsAsync(IReadOnlyList<AssetReadRequest> requests, CancellationToken cancellationToken = default) =>
+            FileSystem.ReadAssetsAsync(requests, cancellationToken);
+        /// <summary>Directory for derived data the engine may regenerate at any time, null to disable caching</summary>
+        string? CachePath { get; }
         ITexture CreateImage(Stream stream);
+        /// <summary>Creates several images at once, backends may decode them in parallel and upload them together</summary>
+        IReadOnlyList<ITexture> CreateImages(IReadOnlyList<Stream> streams) => streams.Select(CreateImage).ToArray();
         IVideoTexture CreateVideo(Stream stream);
+        /// <summary>World renderers are created inactive and may be created on a background thread</summary>
         IPanoramaWorldRenderer CreatePanoramaRenderer(Stream stream, int spriteCapacity);
         IPuzzleWorldRenderer CreatePuzzleRenderer(int spriteCapacity);
 
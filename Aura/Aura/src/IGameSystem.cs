@@ -11,11 +11,19 @@ namespace Aura
         IReadOnlyCollection<IGameSystem> Systems { get; }
         IEnumerable<T> SystemsWith<T>() where T : IGameSystem;
         IBackend Backend { get; }
+        SceneCache SceneCache { get; }
     }
     
     public interface IGameSystem : IDisposable
     {
         void CrossInitialize(IGameSystemContainer container) { }
+        /// <summary>Loads the data of the system after all systems were cross-initialized</summary>
+        /// <remarks>Runs on the thread pool concurrently with the other systems, so it may not depend on their initialization</remarks>
+        void Initialize() { }
+        /// <summary>Whether the initialization may run after the first frame was shown</summary>
+        bool IsInitializationDeferred => false;
+        /// <summary>Called on a background thread while the previous scene is still shown, may only fill the context</summary>
+        void PrepareScene(LoadSceneContext context) { }
         void OnBeforeSceneChange(LoadSceneContext context) { }
         void OnAfterSceneChange() { }
         void RegisterGameFunctions(Interpreter interpreter) { }
@@ -0,0 +1,120 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Threading;
+
+namespace Aura
+{
+    public enum LoadPhase
+    {
+        PackIndex,
+        ScriptDecode,
+        SceneParse,
+        CellScriptParse,
+        /// <summary>Reading the assets of the graphic lists and mapping their arguments while the scene is prepared</summary>
+        GraphicAssets,
+        /// <summary>Executing the graphic lists when the scene is applied</summary>
+        GraphicLists,
+        ObjectLists,
+        OnLoadScene
+    }
+
+    /// <summary>Accumulates wall time and allocated bytes per scene loading phase</summary>
+    /// <remarks>
+    /// Phases may nest, the time of the inner phase is not counted for the outer one. Allocations are
+    /// counted per thread, work a phase hands off to other threads is not attributed to it.
+    /// </remarks>
+    public class LoadProfiler
+    {
+        public struct PhaseStats
+        {
+            public TimeSpan Time;
+            public long AllocatedBytes;
+            public int Count;
+        }
+
+        public readonly struct Scope : IDisposable
+        {
+            private readonly LoadProfiler? profiler;
+
+            internal Scope(LoadProfiler? profiler) => this.profiler = profiler;
+
+            public void Dispose() => profiler?.End();
+        }
+
+        private class ThreadState
+        {
+            public Stack<LoadPhase> Phases = new Stack<LoadPhase>();
+            public long Timestamp;
+            public long AllocatedBytes;
+        }
+
+        private readonly object statsLock = new object();
+        private readonly PhaseStats[] stats = new PhaseStats[Enum.GetValues<LoadPhase>().Length];
+        private readonly ThreadLocal<ThreadState> threadState = new ThreadLocal<ThreadState>(() => new ThreadState());
+
+        public PhaseStats this[LoadPhase phase]
+        {
+            get
+            {
+                lock (statsLock)
+                    return stats[(int)phase];
+            }
+        }
+
+        public IReadOnlyDictionary<LoadPhase, PhaseStats> Phases
+        {
+            get
+            {
+                lock (statsLock)
+                    return Enum.GetValues<LoadPhase>().ToDictionary(p => p, p => stats[(int)p]);
+            }
+        }
+
+        public void Reset()
+        {
+            lock (statsLock)
+                Array.Clear(stats);
+        }
+
+        /// <summary>Measures a phase until the result is disposed, does nothing if there is no profiler</summary>
+        public static Scope Measure(LoadProfiler? profiler, LoadPhase phase)
+        {
+            profiler?.Begin(phase);
+            return new Scope(profiler);
+        }
+
+        private void Begin(LoadPhase phase)
+        {
+            var state = threadState.Value!;
+            Flush(state);
+            state.Phases.Push(phase);
+            lock (statsLock)
+                stats[(int)phase].Count++;
+        }
+
+        private void End()
+        {
+            var state = threadState.Value!;
+            Flush(state);
+            state.Phases.Pop();
+        }
+
+        private void Flush(ThreadState state)
+        {
+            var timestamp = Stopwatch.GetTimestamp();
+            var allocatedBytes = GC.GetAllocatedBytesForCurrentThread(); // cheap, unlike the precise process-wide count
+            if (state.Phases.TryPeek(out var phase))
+            {
+                lock (statsLock)
+                {
+                    stats[(int)phase].Time += TimeSpan.FromSeconds((double)(timestamp - state.Timestamp) / Stopwatch.Frequency);
+                    stats[(int)phase].AllocatedBytes += allocatedBytes - state.AllocatedBytes;
+                }
+            }
+            state.Timestamp = timestamp;
+            state.AllocatedBytes = allocatedBytes;
+        }
+    }
+}
@@ -2,6 +2,7 @@
 using System.Collections.Generic;
 using System.Linq;
 using System.IO;
+using System.Threading.Tasks;
 using Aura.Script;
 
 namespace Aura
@@ -12,37 +13,127 @@ namespace Aura
         Puzzle
     }
 
-    public class LoadSceneContext
+    public class LoadSceneContext : BaseDisposable
     {
-        private Dictionary<string, Func<Stream?>> sceneAssets = new Dictionary<string, Func<Stream?>>();
+        private List<IAssetArchive> assetPacks = new List<IAssetArchive>();
+        private List<IDisposable> sceneMounts = new List<IDisposable>();
+        private PackArchive? scriptPack;
+        private Dictionary<string, (Task<AssetBuffer?[]> batch, int index)> queuedAssets =
+            new Dictionary<string, (Task<AssetBuffer?[]> batch, int index)>(StringComparer.OrdinalIgnoreCase);
+        private PackIndexCache? packIndexCache;
+        private Dictionary<StringNode, ITexture> preloadedImages = new Dictionary<StringNode, ITexture>();
+        private Dictionary<StringNode, IVideoTexture> preloadedVideos = new Dictionary<StringNode, IVideoTexture>();
 
         public IBackend Backend { get; }
         public string ScenePath { get; }
         public string SceneName { get; }
         public SceneType Type { get; }
         public SceneNode Scene { get; }
-        public IReadOnlyDictionary<string, string> ScriptTexts { get; } = new Dictionary<string, string>();
+        /// <summary>The ASCII texts of the scene script pack, keyed by script name</summary>
+        public IReadOnlyDictionary<string, ReadOnlyMemory<byte>> ScriptTexts { get; } = new Dictionary<string, ReadOnlyMemory<byte>>();
+        /// <summary>Shared by the tokenizers of the scene and cell scripts, so repeated names are only allocated once</summary>
+        public IdentifierTable Identifiers { get; } = new IdentifierTable();
+        /// <summary>Holds the nodes of the scene and cell scripts</summary>
+        public SyntaxArena Syntax { get; } = new SyntaxArena();
+        /// <summary>Serialized nodes of the scene and cell scripts from previous visits, null if caching is disabled</summary>
+        public SyntaxCache? SyntaxCache { get; }
         public Queue<IWorldSprite> AvailableWorldSprites { get; set; } = new Queue<IWorldSprite>();
+        /// <summary>The prepared renderer of the scene, disposed with the context unless a system takes it</summary>
+        public IWorldRenderer? WorldRenderer { get; set; }
+        /// <summary>Cell scripts parsed while the scene was prepared, keyed by script name</summary>
+        public IDictionary<string, InstructionBlockNode> CellScripts { get; } = new Dictionary<string, InstructionBlockNode>();
+        public LoadProfiler? Profiler { get; }
 
-        public LoadSceneContext(IBackend backend, string sceneName, SceneType type)
+        public LoadSceneContext(IBackend backend, string sceneName, SceneType type, LoadProfiler? profiler = null)
         {
             sceneName = sceneName.StartsWith(".\\") ? sceneName.Substring(2) : sceneName;
             Backend = backend;
             SceneName = sceneName;
             ScenePath = $"Scenes/{sceneName}/";
             Type = type;
+            Profiler = profiler;
+            if (backend.CachePath != null)
+                packIndexCache = new PackIndexCache(Path.Combine(backend.CachePath, "packs"));
 
-            AddAssetPack($"{ScenePath}{sceneName}.psp");
-            AddAssetPack($"{ScenePath}{sceneName}.pvd");
-
-            using var scriptPack = backend.OpenAssetFile($"{ScenePath}{sceneName}.psc");
-            if (scriptPack == null)
-                throw new FileNotFoundException($"Could not find required scene script pack for {sceneName}");
-            ScriptTexts = ReadScriptPack(scriptPack);
-            if (!ScriptTexts.TryGetValue($"{sceneName}.scc", out var sceneScriptText))
-                throw new InvalidDataException($"Script pack for {sceneName} does not have a scene script");
-            var sceneScanner = new Tokenizer($"{sceneName}.scc", sceneScriptText);
-            Scene = new SceneScriptParser(sceneScanner).ParseSceneScript();
+            try
+            {
+                using (LoadProfiler.Measure(profiler, LoadPhase.PackIndex))
+                {
+                    var nativePack = OpenNativePack();
+                    if (nativePack != null)
+                    {
+                        MountAssetPack(nativePack);
+                        ScriptTexts = new ScriptTextDictionary(nativePack.ScriptNames, n =>
+                        {
+                            using var decodeScope = LoadProfiler.Measure(profiler, LoadPhase.ScriptDecode);
+                            return nativePack.ReadScriptBytes(n)!.Value;
+                        });
+                    }
+                    else
+                    {
+                        AddAssetPack($"{ScenePath}{sceneName}.psp");
+                        AddAssetPack($"{ScenePath}{sceneName}.pvd");
+
+                        var scriptPackStream = backend.OpenAssetFile($"{ScenePath}{sceneName}.psc");
+                        if (scriptPackStream == null)
+                            throw new FileNotFoundException($"Could not find required scene script pack for {sceneName}");
+                        var scriptPack = this.scriptPack = new PackArchive(scriptPackStream, PackKind.Scripts, packIndexCache);
+                        var scriptEntries = scriptPack.Entries.ToDictionary(e => e.Name);
+                        ScriptTexts = new ScriptTextDictionary(scriptEntries.Keys, n =>
+                        {
+                            using var decodeScope = LoadProfiler.Measure(profiler, LoadPhase.ScriptDecode);
+                            return scriptPack.ReadScriptBytes(scriptEntries[n]);
+                        });
+                    }
+                }
+                if (type == SceneType.Panorama)
+                    QueueSceneAssets($"{sceneName}.bik"); // read the background while the scene script is parsed
+                if (!ScriptTexts.TryGetValue($"{sceneName}.scc", out var sceneScriptText))
+                    throw new InvalidDataException($"Script pack for {sceneName} does not have a scene script");
+                using var parseScope = LoadProfiler.Measure(profiler, LoadPhase.SceneParse);
+                SyntaxCache = SyntaxCache.Open(backend.CachePath, sceneName);
+                var sceneScanner = new Tokenizer($"{sceneName}.scc", sceneScriptText, Identifiers);
+                Scene = new SceneScriptParser(sceneScanner, Syntax, SyntaxCache).ParseSceneScript();
+            }
+            catch
+            {
+                Dispose(); // unmount the packs that were already mounted
+                throw;
+            }
+        }
+
+        protected override void DisposeManaged()
+        {
+            foreach (var (batch, index) in queuedAssets.Values)
+            {
+                batch.ContinueWith(t => t.Result[index]?.Dispose(),
+                    TaskContinuationOptions.OnlyOnRanToCompletion | TaskContinuationOptions.ExecuteSynchronously);
+            }
+            queuedAssets.Clear();
+            foreach (var texture in preloadedImages.Values.Concat<ITexture>(preloadedVideos.Values))
+                texture.Dispose();
+            preloadedImages.Clear();
+            preloadedVideos.Clear();
+            WorldRenderer?.Dispose();
+            foreach (var sceneMount in sceneMounts)
+                sceneMount.Dispose();
+            scriptPack?.Dispose();
+        }
+
+        /// <summary>Opens the native pack of the scene unless the packs it was converted from were patched or replaced since</summary>
+        private NativePackArchive? OpenNativePack()
+        {
+            var nativePackStream = Backend.OpenAssetFile($"{ScenePath}{SceneName}.anp");
+            if (nativePackStream == null)
+                return null;
+            var nativePack = new NativePackArchive(nativePackStream);
+            var sourcePaths = NativePackArchive.SourceExtensions
+                .Select(e => Backend.FileSystem.TryLocateAsset($"{ScenePath}{SceneName}{e}", out var location) ? location.FilePath : null)
+                .ToArray();
+            if (nativePack.MatchesSources(sourcePaths))
+                return nativePack;
+            nativePack.Dispose();
+            return null;
         }
 
         private void AddAssetPack(string filePath)
@@ -51,62 +142,147 @@ namespace Aura
             if (packFileStream == null)
                 return;
 
-            var packFile = new PackFileReader(packFileStream);
-            var files = packFile
-                .ReadFileList()
-                .Select(fileName =>
+            var packArchive = new PackArchive(packFileStream, PackKind.Assets, packIndexCache);
+            // enumerating decodes the names of a cached directory, which the first pack does not need
+            foreach (var entry in assetPacks.Count > 0 ? packArchive.Entries : Array.Empty<PackEntry>())
+            {
+                if (assetPacks.Any(p => p.HasAsset(entry.Name)))
                 {
-                    int length = (int)packFile.ReadU32();
-                    return (fileName, buffer: packFile.ReadRaw(length));
-                });
-            foreach (var file in files)
-                AddAssetFile(file.fileName, () => new MemoryStream(file.buffer, writable: false));
+                    packArchive.Dispose();
+                    throw new InvalidDataException($"Scene asset {entry.Name} was found twice");
+                }
+            }
+            MountAssetPack(packArchive);
         }
 
-        private void AddAssetFile(string fileName, Func<Stream> streamAccessor)
+        private void MountAssetPack(IAssetArchive assetPack)
         {
-            fileName = fileName.ToLowerInvariant();
-            if (sceneAssets.ContainsKey(fileName))
-                throw new InvalidDataException($"Scene asset {fileName} was found twice");
-            sceneAssets[fileName] = streamAccessor;
+            assetPacks.Add(assetPack);
+            sceneMounts.Add(Backend.FileSystem.Mount(ScenePath, assetPack));
         }
 
-        private static Dictionary<string, string> ReadScriptPack(Stream stream)
+        private static string TrimCurrentDirectory(string name) => name.StartsWith(".\\") ? name.Substring(2) : name;
+
+        /// <summary>Starts reading scene assets in the background, the next <see cref="OpenSceneAsset(string)"/> of them takes the result</summary>
+        public void QueueSceneAssets(params string[] names)
         {
-            PackFileReader scriptPack = new PackFileReader(stream);
-            string[] fileNames = scriptPack.ReadFileList();
-            var files = new Dictionary<string, string>();
+            names = names.Select(TrimCurrentDirectory).Where(n => !queuedAssets.ContainsKey(n)).Distinct(StringComparer.OrdinalIgnoreCase).ToArray();
+            if (names.Length == 0)
+                return;
+            var batch = Backend.ReadAssetsAsync(names.Select(n => new AssetReadRequest(ScenePath + n)).ToArray()).AsTask();
+            for (int i = 0; i < names.Length; i++)
+                queuedAssets.Add(names[i], (batch, i));
+        }
+
+        /// <summary>Starts reading all scene assets referenced by the graphic lists</summary>
+        public void QueueGraphicAssets()
+        {
+            var names = Scene.EntityLists.Values
+                .OfType<GraphicListNode>()
+                .SelectMany(l => l.Graphics.Values)
+                .SelectMany(g => g.Value.Arguments)
+                .OfType<StringNode>()
+                .Select(n => TrimCurrentDirectory(n.Value))
+                .Where(n => Backend.FileSystem.HasAsset(ScenePath + n)); // skips non-asset strings like cube faces
+            QueueSceneAssets(names.ToArray());
+        }
+
+        /// <summary>Approximate memory held by the context, used to budget retained scenes</summary>
+        public long MemorySize => QueuedAssetSize + Syntax.MemorySize + (WorldRenderer?.MemorySize ?? 0);
 
-            foreach (var fileName in fileNames)
+        /// <summary>Size of the assets which were read ahead but not opened yet</summary>
+        /// <remarks>Reads still in flight are not counted, it is polled every frame so it does not allocate</remarks>
+        public long QueuedAssetSize
+        {
+            get
             {
-                var fileContent = new StringWriter();
-                uint lineCount = scriptPack.ReadU32();
-                for (uint i = 0; i < lineCount; i++)
+                long size = 0;
+                foreach (var (batch, index) in queuedAssets.Values)
                 {
-                    var nextLine = scriptPack.ReadString((int)scriptPack.ReadU32());
-                    if (nextLine.EndsWith("\n"))
-                        fileContent.Write(nextLine);
-                    else
-                        fileContent.WriteLine(nextLine);
+                    if (batch.IsCompletedSuccessfully)
+                        size += batch.Result[index]?.Length ?? 0;
                 }
-                files[fileName] = fileContent.ToString();
+                return size;
             }
-            return files;
         }
 
         public Stream? OpenSceneAsset(string name)
         {
-            if (name.StartsWith(".\\"))
-                name = name.Substring(2);
-            name = name.ToLowerInvariant();
-            return sceneAssets.TryGetValue(name, out var streamAccessor)
-                ? streamAccessor()
-                : null;
+            if (queuedAssets.Count > 0)
+            {
+                name = TrimCurrentDirectory(name);
+                if (queuedAssets.Remove(name, out var queued))
+                {
+                    var buffer = queued.batch.GetAwaiter().GetResult()[queued.index];
+                    if (buffer != null)
+                        return buffer.ToStream();
+                }
+            }
+            return Backend.FileSystem.OpenAsset(ScenePath, name);
+        }
+
+        private static bool IsIgnoredVideo(string videoName) =>
+            videoName.Contains("An_"); // weird stuff, two puzzle scenes use it with no visible difference...
+
+        /// <summary>Loads the given images and videos together, the next <see cref="ScrArgLoadImage"/> or <see cref="ScrArgLoadVideo"/> of a node takes the result</summary>
+        /// <remarks>The images are created as one batch, the videos are opened in parallel</remarks>
+        public void PreloadGraphics(IEnumerable<StringNode> imageNodes, IEnumerable<StringNode> videoNodes)
+        {
+            var images = imageNodes.Distinct().Where(n => !preloadedImages.ContainsKey(n)).ToArray();
+            var videos = videoNodes.Distinct().Where(n => !preloadedVideos.ContainsKey(n) && !IsIgnoredVideo(n.Value)).ToArray();
+            QueueSceneAssets(images.Concat(videos).Select(n => n.Value).ToArray());
+
+            var imageStreams = new Stream?[images.Length];
+            try
+            {
+                for (int i = 0; i < images.Length; i++)
+                {
+                    imageStreams[i] = OpenSceneAsset(images[i].Value) ??
+                        throw new FileNotFoundException($"{images[i].Position}: Could not find texture \"{images[i].Value}\"");
+                }
+                var textures = Backend.CreateImages(imageStreams!);
+                for (int i = 0; i < images.Length; i++)
+                    preloadedImages.Add(images[i], textures[i]);
+            }
+            finally
+            {
+                foreach (var stream in imageStreams)
+                    stream?.Dispose();
+            }
+
+            var videoStreams = new Stream?[videos.Length];
+            var videoTextures = new IVideoTexture?[videos.Length];
+            try
+            {
+                for (int i = 0; i < videos.Length; i++)
+                {
+                    videoStreams[i] = OpenSceneAsset(videos[i].Value) ??
+                        throw new FileNotFoundException($"{videos[i].Position}: Could not find video \"{videos[i].Value}\"");
+                }
+                Parallel.For(0, videos.Length, i =>
+                {
+                    videoTextures[i] = Backend.CreateVideo(videoStreams[i]!);
+                    videoStreams[i] = null; // owned by the video
+                });
+                for (int i = 0; i < videos.Length; i++)
+                    preloadedVideos.Add(videos[i], videoTextures[i]!);
+            }
+            catch
+            {
+                foreach (var stream in videoStreams)
+                    stream?.Dispose();
+                foreach (var video in videoTextures)
+                    video?.Dispose();
+                throw;
+            }
         }
 
         public ITexture ScrArgLoadImage(ValueNode node)
         {
-            var textureName = ((StringNode)node).Value;
+            var stringNode = (StringNode)node;
+            if (preloadedImages.Remove(stringNode, out var preloaded))
+                return preloaded;
+            var textureName = stringNode.Value;
             using var stream = OpenSceneAsset(textureName);
             if (stream == null)
                 throw new FileNotFoundException($"{node.Position}: Could not find texture \"{textureName}\"");
@@ -115,8 +291,11 @@ namespace Aura
 
         public ITexture ScrArgLoadVideo(ValueNode node)
         {
-            var videoName = ((StringNode)node).Value;
-            if (videoName.Contains("An_")) // weird stuff, two puzzle scenes use it with no visible difference...
+            var stringNode = (StringNode)node;
+            if (preloadedVideos.Remove(stringNode, out var preloaded))
+                return preloaded;
+            var videoName = stringNode.Value;
+            if (IsIgnoredVideo(videoName))
                 return null!;
             var stream = OpenSceneAsset(videoName);
             if (stream == null)
@@ -0,0 +1,74 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace Aura
+{
+    /// <summary>Keeps recently left scenes loaded so that returning to them skips most of the loading</summary>
+    /// <remarks>
+    /// A retained scene keeps its parsed scripts, its mounted packs and its world renderer. The least
+    /// recently left scenes are disposed once the retained scenes exceed <see cref="MemoryBudget"/>.
+    /// </remarks>
+    public class SceneCache : BaseDisposable
+    {
+        private readonly LinkedList<LoadSceneContext> contexts = new LinkedList<LoadSceneContext>(); // least recently left first
+        private long memoryBudget = 256 * 1024 * 1024;
+
+        public long MemoryBudget
+        {
+            get => memoryBudget;
+            set
+            {
+                memoryBudget = value;
+                Trim();
+            }
+        }
+
+        protected override void DisposeManaged()
+        {
+            foreach (var context in contexts)
+                context.Dispose();
+            contexts.Clear();
+        }
+
+        /// <summary>Takes ownership of a context that is not shown anymore</summary>
+        public void Retain(LoadSceneContext context)
+        {
+            contexts.AddLast(context);
+            Trim();
+        }
+
+        public bool Contains(string sceneName, SceneType type) => Find(sceneName, type) != null;
+
+        /// <summary>Hands over a retained scene to the caller, which has to dispose the context</summary>
+        public LoadSceneContext? Take(string sceneName, SceneType type)
+        {
+            var node = Find(sceneName, type);
+            if (node == null)
+                return null;
+            contexts.Remove(node);
+            return node.Value;
+        }
+
+        private LinkedListNode<LoadSceneContext>? Find(string sceneName, SceneType type)
+        {
+            sceneName = sceneName.StartsWith(".\\") ? sceneName.Substring(2) : sceneName;
+            var node = contexts.First;
+            while (node != null && (node.Value.Type != type || !node.Value.SceneName.Equals(sceneName, StringComparison.OrdinalIgnoreCase)))
+                node = node.Next;
+            return node;
+        }
+
+        private void Trim()
+        {
+            long totalSize = contexts.Sum(c => c.MemorySize);
+            while ((totalSize > memoryBudget || memoryBudget <= 0) && contexts.First != null) // zero disables retention
+            {
+                var context = contexts.First.Value;
+                contexts.RemoveFirst();
+                totalSize -= context.MemorySize;
+                context.Dispose();
+            }
+        }
+    }
+}
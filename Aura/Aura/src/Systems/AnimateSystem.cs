@@ -4,7 +4,7 @@ using Aura.Script;
 
 namespace Aura.Systems
 {
-    public class AnimateSystem : BaseAnimateSystem
+    public partial class AnimateSystem : BaseAnimateSystem
     {
         public override string GraphicListName => "&Animate";
 
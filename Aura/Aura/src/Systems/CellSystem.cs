@@ -59,8 +59,11 @@ namespace Aura.Systems
         private Interpreter? interpreter;
         private CursorSystem? cursorSystem;
         private Dictionary<string, Cell> cells = new Dictionary<string, Cell>();
+        private readonly VariableSlots slots = new VariableSlots(); // kept across scenes, so compiled scripts stay valid
+        private Cell?[] cellsBySlot = Array.Empty<Cell?>();
 
         public IEnumerable<Cell> Cells => cells.Values;
+        public Cell? HoveredCell { get; private set; }
 
         public int this[string name]
         {
@@ -78,6 +81,22 @@ namespace Aura.Systems
             }
         }
 
+        public int GetSlot(string name) => slots.GetSlot(name);
+
+        public int this[int slot]
+        {
+            get => CellAt(slot).IsActive ? 1 : 0;
+            set => CellAt(slot).IsActive = value != 0;
+        }
+
+        private Cell CellAt(int slot)
+        {
+            var cell = slot < cellsBySlot.Length ? cellsBySlot[slot] : null;
+            if (cell == null)
+                throw new ArgumentOutOfRangeException($"Unknown cell name {slots.GetName(slot)}");
+            return cell;
+        }
+
         public void CrossInitialize(IGameSystemContainer container)
         {
             cursorSystem = container.SystemsWith<CursorSystem>().Single();
@@ -86,6 +105,29 @@ namespace Aura.Systems
         public void OnBeforeSceneChange(LoadSceneContext _)
         {
             cells.Clear();
+            Array.Clear(cellsBySlot);
+            HoveredCell = null;
+        }
+
+        public void PrepareScene(LoadSceneContext context)
+        {
+            if (!context.Scene.EntityLists.TryGetValue(ObjectListName, out var entityList) || !(entityList is ObjectListNode))
+                return;
+            using var parseScope = LoadProfiler.Measure(context.Profiler, LoadPhase.CellScriptParse);
+            foreach (var objectNode in ((ObjectListNode)entityList).Objects.Values)
+            {
+                if (objectNode.Properties.TryGetValue("script", out var scriptProp) && scriptProp.Value is StringNode scriptNode &&
+                    !context.CellScripts.ContainsKey(scriptNode.Value))
+                    context.CellScripts.Add(scriptNode.Value, ParseCellScript(context, scriptNode));
+            }
+        }
+
+        private static InstructionBlockNode ParseCellScript(LoadSceneContext context, StringNode scriptNode)
+        {
+            if (!context.ScriptTexts.TryGetValue(scriptNode.Value.Replace(".\\", ""), out var scriptText))
+                throw new InvalidDataException($"{scriptNode.Position}: Could not find cell script {scriptNode.Value}");
+            var scanner = new Tokenizer(scriptNode.Value, scriptText, context.Identifiers);
+            return new CellScriptParser(scanner, context.Syntax, context.SyntaxCache).ParseCellScript();
         }
 
         public void AddObject(LoadSceneContext context, ObjectNode objectNode)
@@ -107,8 +149,6 @@ namespace Aura.Systems
             var cursorNode = objectNode.Properties.GetValueOrDefault("cursor");
             CursorType? cursor = null;
 
-            if (!context.ScriptTexts.TryGetValue(scriptNode.Value.Replace(".\\", ""), out var scriptText))
-                throw new InvalidDataException($"{scriptNode.Position}: Could not find cell script {scriptNode.Value}");
             if (cursorNode != default)
             {
                 if (!(cursorNode.Value is VariableNode))
@@ -118,15 +158,20 @@ namespace Aura.Systems
                     throw new InvalidDataException($"{cursorNode.Position}: Invalid cursor name \"{cursorName}\"");
                 cursor = cursorType;
             }
-            var scanner = new Tokenizer(scriptNode.Value, scriptText);
-            var action = new CellScriptParser(scanner).ParseCellScript();
+            if (!context.CellScripts.TryGetValue(scriptNode.Value, out var action))
+                action = ParseCellScript(context, scriptNode);
 
-            cells[objectNode.Name] = new Cell(
+            var cell = new Cell(
                 objectNode.Name,
                 new Vector2(posNode.X, posNode.Y),
                 new Vector2(sizeNode.X, sizeNode.Y),
                 action,
                 cursor);
+            cells[objectNode.Name] = cell;
+            int slot = slots.GetSlot(objectNode.Name);
+            if (slot >= cellsBySlot.Length)
+                Array.Resize(ref cellsBySlot, Math.Max(slot + 1, cellsBySlot.Length * 2));
+            cellsBySlot[slot] = cell;
         }
 
         public Cell? FindActiveCellAt(Vector2 pos) =>
@@ -149,9 +194,10 @@ namespace Aura.Systems
         public void Update(float timeDelta)
         {
             var worldPos = cursorSystem?.WorldPos;
+            HoveredCell = null;
             if (worldPos == null || cursorSystem == null)
                 return;
-            var cell = FindActiveCellAt(worldPos.Value);
+            var cell = HoveredCell = FindActiveCellAt(worldPos.Value);
             cursorSystem.BackgroundType = cell == null ? CursorType.Default : cell.Cursor ?? CursorType.Active;
         }
     }
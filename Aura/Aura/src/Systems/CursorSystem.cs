@@ -19,7 +19,7 @@ namespace Aura.Systems
         // TODO: Custom?
     }
 
-    public class CursorSystem : BaseDisposable, IGameSystem
+    public partial class CursorSystem : BaseDisposable, IGameSystem
     {
         private static readonly IReadOnlyDictionary<CursorType, string> cursorTextureNames = new Dictionary<CursorType, string>()
         {
@@ -34,7 +34,9 @@ namespace Aura.Systems
         private GameWorldRendererSystem? worldRendererSystem;
         private IPuzzleWorldRenderer? renderer;
         private IWorldSprite? sprite;
-        private ITexture[] textures = Array.Empty<ITexture>();
+        private ITexture?[] textures = new ITexture?[Enum.GetValues(typeof(CursorType)).Length];
+        private volatile bool areTexturesLoaded = false;
+        private bool isLoadedCursorShown = false;
         private CursorType backgroundType = CursorType.Empty;
         private CursorType? foregroundType = null;
 
@@ -65,8 +67,8 @@ namespace Aura.Systems
             get => ForegroundType ?? BackgroundType;
             private set
             {
-                if (sprite == null)
-                    return;
+                if (sprite == null || !areTexturesLoaded)
+                    return; // shown by Update once the textures are loaded
                 sprite.IsEnabled = value != CursorType.Empty;
                 sprite.Texture = textures[(int)value];
             }
@@ -88,26 +90,55 @@ namespace Aura.Systems
         {
             renderer?.Dispose();
             foreach (var texture in textures)
-                texture.Dispose();
+                texture?.Dispose();
         }
 
+        public bool IsInitializationDeferred => true; // the cursor is not needed before the first frame
+
         public void CrossInitialize(IGameSystemContainer container)
         {
             backend = container.Backend;
             worldRendererSystem = container.SystemsWith<GameWorldRendererSystem>().Single();
             renderer = backend.CreatePuzzleRenderer(1);
             renderer.Order = 1000;
+            renderer.IsActive = true;
             sprite = renderer.Sprites.Single();
             sprite.IsEnabled = false;
             sprite.Face = CubeFace.Front;
-            textures = new ITexture[Enum.GetValues(typeof(CursorType)).Length];
-            foreach (var pair in cursorTextureNames)
+        }
+
+        public void Initialize()
+        {
+            if (backend == null)
+                return;
+            var loadedTextures = new ITexture?[textures.Length];
+            var cursorTextures = cursorTextureNames.ToArray();
+            var imageBuffers = backend
+                .ReadAssetsAsync(cursorTextures.Select(p => new AssetReadRequest(p.Value)).ToArray())
+                .AsTask().GetAwaiter().GetResult();
+            try
             {
-                using var imageStream = backend.OpenAssetFile(pair.Value);
-                if (imageStream == null)
-                    throw new FileNotFoundException($"Could not find cursor texture: {pair.Value}");
-                textures[(int)pair.Key] = backend.CreateImage(imageStream);
+                for (int i = 0; i < cursorTextures.Length; i++)
+                {
+                    if (imageBuffers[i] == null)
+                        throw new FileNotFoundException($"Could not find cursor texture: {cursorTextures[i].Value}");
+                    using var imageStream = imageBuffers[i]!.ToStream();
+                    loadedTextures[(int)cursorTextures[i].Key] = backend.CreateImage(imageStream);
+                }
             }
+            catch
+            {
+                foreach (var texture in loadedTextures)
+                    texture?.Dispose();
+                throw;
+            }
+            finally
+            {
+                foreach (var imageBuffer in imageBuffers)
+                    imageBuffer?.Dispose();
+            }
+            textures = loadedTextures;
+            areTexturesLoaded = true;
         }
 
         public void RegisterGameFunctions(Interpreter interpreter)
@@ -124,6 +155,11 @@ namespace Aura.Systems
 
         public void Update(float timeDelta)
         {
+            if (areTexturesLoaded && !isLoadedCursorShown)
+            {
+                isLoadedCursorShown = true;
+                Type = Type; // show the cursor that was set while loading
+            }
             if (sprite == null || sprite.Texture == null || backend == null)
                 return;
             sprite.Position = backend.CursorPosition - sprite.Texture.Size / 2.0f;
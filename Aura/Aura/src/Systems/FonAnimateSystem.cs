@@ -3,7 +3,7 @@ using Aura.Script;
 
 namespace Aura.Systems
 {
-    public class FonAnimateSystem : BaseAnimateSystem
+    public partial class FonAnimateSystem : BaseAnimateSystem
     {
         public override string GraphicListName => "&Fon_Animate";
 
@@ -7,7 +7,7 @@ using Aura.Script;
 
 namespace Aura.Systems
 {
-    public class FullScreenVideoSystem : BaseDisposable, IGameSystem
+    public partial class FullScreenVideoSystem : BaseDisposable, IGameSystem
     {
         private LoadSceneContext? context;
         private IPuzzleWorldRenderer? renderer;
@@ -18,6 +18,7 @@ namespace Aura.Systems
         {
             renderer = container.Backend.CreatePuzzleRenderer(1);
             renderer.Order = 2000;
+            renderer.IsActive = true;
             sprite = renderer.Sprites.Single();
             sprite.IsEnabled = false;
             sprite.Face = CubeFace.Front;
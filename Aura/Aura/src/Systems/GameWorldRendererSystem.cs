@@ -7,7 +7,7 @@ using Aura.Script;
 
 namespace Aura.Systems
 {
-    public class GameWorldRendererSystem : BaseDisposable, IGameSystem
+    public partial class GameWorldRendererSystem : BaseDisposable, IGameSystem
     {
         public IWorldRenderer? WorldRenderer { get; private set; }
         public bool IsPanorama => WorldRenderer is IPanoramaWorldRenderer;
@@ -29,26 +29,54 @@ namespace Aura.Systems
                 OnWorldClick += system.OnWorldClick;
         }
 
-        public void OnBeforeSceneChange(LoadSceneContext context)
+        public void PrepareScene(LoadSceneContext context)
         {
-            this.context = context;
+            if (context.WorldRenderer != null) // retained from an earlier visit
+            {
+                context.AvailableWorldSprites = new Queue<IWorldSprite>(context.WorldRenderer.Sprites);
+                return;
+            }
             var graphicLists = context.Scene.EntityLists.Values.OfType<GraphicListNode>();
             int spriteCapacity = graphicLists.Sum(l => l.Graphics.Count);
-            WorldRenderer?.Dispose();
             switch(context.Type)
             {
                 case SceneType.Panorama:
-                    var stream = context.OpenSceneAsset($"{context.SceneName}.bik");
-                    if (stream == null)
-                        throw new FileNotFoundException($"Could not find background video for scene {context.SceneName}");
-                    WorldRenderer = context.Backend.CreatePanoramaRenderer(stream, spriteCapacity);
+                    using (var stream = context.OpenSceneAsset($"{context.SceneName}.bik"))
+                    {
+                        if (stream == null)
+                            throw new FileNotFoundException($"Could not find background video for scene {context.SceneName}");
+                        context.WorldRenderer = context.Backend.CreatePanoramaRenderer(stream, spriteCapacity);
+                    }
                     break;
                 case SceneType.Puzzle:
-                    WorldRenderer = context.Backend.CreatePuzzleRenderer(spriteCapacity);
+                    context.WorldRenderer = context.Backend.CreatePuzzleRenderer(spriteCapacity);
                     break;
                 default: throw new NotSupportedException($"Unsupported scene type to load world renderer {context.Type}");
             }
-            context.AvailableWorldSprites = new Queue<IWorldSprite>(WorldRenderer.Sprites);
+            context.AvailableWorldSprites = new Queue<IWorldSprite>(context.WorldRenderer.Sprites);
+        }
+
+        public void OnBeforeSceneChange(LoadSceneContext context)
+        {
+            if (context.WorldRenderer == null)
+                throw new InvalidProgramException($"Scene {context.SceneName} was not prepared");
+            if (this.context != null && WorldRenderer != null)
+            {
+                // the previous context keeps its renderer in case the scene is retained
+                WorldRenderer.IsActive = false;
+                foreach (var sprite in WorldRenderer.Sprites)
+                {
+                    sprite.IsEnabled = false;
+                    sprite.Texture = null;
+                }
+                this.context.WorldRenderer = WorldRenderer;
+            }
+            else
+                WorldRenderer?.Dispose();
+            this.context = context;
+            WorldRenderer = context.WorldRenderer;
+            WorldRenderer.IsActive = true;
+            context.WorldRenderer = null;
         }
 
         public void Update(float timeDelta) => lastTimeDelta = timeDelta;
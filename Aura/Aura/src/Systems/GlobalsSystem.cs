@@ -22,17 +22,27 @@ namespace Aura.Systems
         };
         private Regex NameRegex = new Regex(@"^%\w+$");
 
-        private IReadOnlyDictionary<string, int> DefaultValues { get; }
-        private Dictionary<string, int> values;
+        private readonly IBackend backend;
+        private IReadOnlyDictionary<string, int> DefaultValues { get; set; } = new Dictionary<string, int>();
+        private readonly VariableSlots slots = new VariableSlots(); // scripts may have resolved slots before initialization
+        private int[] values = Array.Empty<int>(); // indexed by slot
+        private bool[] isDefined = Array.Empty<bool>();
 
         public GlobalsSystem(IBackend backend)
+        {
+            this.backend = backend;
+        }
+
+        public void Initialize()
         {
             using var defaultValuesStream = backend.OpenAssetFile(DefaultValueFile);
             if (defaultValuesStream == null)
                 throw new FileNotFoundException($"Could not open {DefaultValueFile} for default values");
             using var streamReader = new StreamReader(defaultValuesStream);
             var scanner = new Tokenizer(DefaultValueFile, streamReader.ReadToEnd());
-            var defaultValueNodes = new DefaultValueListParser(scanner).ParseDefaultValueList();
+            var syntaxCache = SyntaxCache.Open(backend.CachePath, DefaultValueFile);
+            var defaultValueNodes = new DefaultValueListParser(scanner, cache: syntaxCache).ParseDefaultValueList();
+            syntaxCache?.Save();
 
             var defaultValues = new Dictionary<string, int>();
             foreach (var node in defaultValueNodes.Values)
@@ -57,23 +67,45 @@ namespace Aura.Systems
             }
             DefaultValues = defaultValues;
 
-            values = defaultValues.ToDictionary(p => p.Key, p => p.Value);
+            var valueSlots = defaultValues.Keys.Select(slots.GetSlot).ToArray();
+            values = new int[slots.Count];
+            isDefined = new bool[values.Length];
+            foreach (var (slot, value) in valueSlots.Zip(defaultValues.Values))
+            {
+                values[slot] = value;
+                isDefined[slot] = true;
+            }
+        }
+
+        private int ValueSlot(int slot)
+        {
+            if (slot >= isDefined.Length || !isDefined[slot])
+                throw new ArgumentOutOfRangeException(nameof(slot), $"Unknown global variable \"{slots.GetName(slot)}\"");
+            return slot;
         }
 
         public int this[string name]
         {
             get
             {
-                if (!values.TryGetValue(name, out int value))
+                if (!slots.TryGetSlot(name, out var slot))
                     throw new ArgumentOutOfRangeException(nameof(name), $"Unknown global variable \"{name}\"");
-                return value;
+                return values[ValueSlot(slot)];
             }
             set
             {
-                if (!values.ContainsKey(name))
+                if (!slots.TryGetSlot(name, out var slot))
                     throw new ArgumentOutOfRangeException(nameof(name), $"Unknown global variable \"{name}\"");
-                values[name] = value;
+                values[ValueSlot(slot)] = value;
             }
         }
+
+        public int GetSlot(string name) => slots.GetSlot(name);
+
+        public int this[int slot]
+        {
+            get => values[ValueSlot(slot)];
+            set => values[ValueSlot(slot)] = value;
+        }
     }
 }
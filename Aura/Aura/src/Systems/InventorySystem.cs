@@ -14,12 +14,22 @@ namespace Aura.Systems
 
         public string VariableSetName => "Predmet";
 
-        public IReadOnlyDictionary<string, Item> AllItems { get; }
+        public IReadOnlyDictionary<string, Item> AllItems { get; private set; } = new Dictionary<string, Item>();
+        /// <summary>The held items in the order they were picked up</summary>
         public IEnumerable<Item> CurrentItems => currentItems;
 
-        private HashSet<Item> currentItems = new HashSet<Item>();
+        private readonly IBackend backend;
+        private readonly VariableSlots slots = new VariableSlots(); // scripts may have resolved slots before initialization
+        private Item?[] items = Array.Empty<Item?>(); // indexed by slot
+        private bool[] isCurrent = Array.Empty<bool>();
+        private readonly List<Item> currentItems = new List<Item>();
 
         public InventorySystem(IBackend backend)
+        {
+            this.backend = backend;
+        }
+
+        public void Initialize()
         {
             var encoding = System.Text.Encoding.GetEncoding("Latin1"); // TODO: Latin1 might only be correct for german
             using var stream = backend.OpenAssetFile(ItemListFile);
@@ -29,7 +39,9 @@ namespace Aura.Systems
             var objectListText = streamReader.ReadToEnd();
             objectListText = DescriptionRegex.Replace(objectListText, "Description=\"$1\";"); // easiest way for a very hacky file format
             var scanner = new Tokenizer(ItemListFile, objectListText);
-            var objectList = new ObjectListParser(scanner).ParseObjectList();
+            var syntaxCache = SyntaxCache.Open(backend.CachePath, ItemListFile);
+            var objectList = new ObjectListParser(scanner, cache: syntaxCache).ParseObjectList();
+            syntaxCache?.Save();
 
             var allItems = new Dictionary<string, Item>();
             foreach (var objectNode in objectList)
@@ -40,6 +52,29 @@ namespace Aura.Systems
                 allItems.Add(item.Name, item);
             }
             AllItems = allItems;
+            var itemSlots = allItems.Keys.Select(slots.GetSlot).ToArray();
+            items = new Item?[slots.Count];
+            isCurrent = new bool[items.Length];
+            foreach (var (slot, item) in itemSlots.Zip(allItems.Values))
+                items[slot] = item;
+        }
+
+        private int ItemSlot(int slot)
+        {
+            if (slot >= items.Length || items[slot] == null)
+                throw new ArgumentOutOfRangeException(nameof(slot), $"Unknown item \"{slots.GetName(slot)}\"");
+            return slot;
+        }
+
+        private void SetCurrent(int slot, bool value)
+        {
+            if (isCurrent[slot] == value)
+                return;
+            isCurrent[slot] = value;
+            if (value)
+                currentItems.Add(items[slot]!);
+            else
+                currentItems.Remove(items[slot]!);
         }
 
         protected override void DisposeManaged()
@@ -52,19 +87,24 @@ namespace Aura.Systems
         {
             get
             {
-                if (!AllItems.TryGetValue(name, out var item))
+                if (!slots.TryGetSlot(name, out var slot))
                     throw new ArgumentOutOfRangeException(nameof(name), $"Unknown item \"{name}\"");
-                return CurrentItems.Contains(item) ? 1 : 0;
+                return isCurrent[ItemSlot(slot)] ? 1 : 0;
             }
             set
             {
-                if (!AllItems.TryGetValue(name, out var item))
+                if (!slots.TryGetSlot(name, out var slot))
                     throw new ArgumentOutOfRangeException(nameof(name), $"Unknown item \"{name}\"");
-                if (value == 0)
-                    currentItems.Remove(item);
-                else
-                    currentItems.Add(item);
+                SetCurrent(ItemSlot(slot), value != 0);
             }
         }
+
+        public int GetSlot(string name) => slots.GetSlot(name);
+
+        public int this[int slot]
+        {
+            get => isCurrent[ItemSlot(slot)] ? 1 : 0;
+            set => SetCurrent(ItemSlot(slot), value != 0);
+        }
     }
 }
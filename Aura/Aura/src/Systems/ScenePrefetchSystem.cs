@@ -0,0 +1,216 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+using Aura.Script;
+
+namespace Aura.Systems
+{
+    /// <summary>Starts loading the scene a hovered cell would transfuse to</summary>
+    /// <remarks>
+    /// Prefetched scenes have their packs mounted, their scene script parsed and their graphic assets
+    /// read. At most <see cref="MaxPendingPrefetches"/> scenes are loaded at once, the oldest loaded
+    /// scenes are discarded once their memory exceeds <see cref="MemoryBudget"/>.
+    /// </remarks>
+    public class ScenePrefetchSystem : BaseDisposable, IGameSystem
+    {
+        private static readonly IReadOnlyDictionary<string, SceneType> TransfuseFunctions = new Dictionary<string, SceneType>()
+        {
+            { "LoadSceneTransfuse", SceneType.Panorama },
+            { "LoadScene", SceneType.Panorama },
+            { "LoadPuzzleTransfuse", SceneType.Puzzle }
+        };
+
+        private class Prefetch
+        {
+            public string SceneName = "";
+            public SceneType Type;
+            public Task<LoadSceneContext> Task = null!;
+        }
+
+        private IBackend? backend;
+        private CellSystem? cellSystem;
+        private SceneCache? sceneCache;
+        private string currentSceneName = "";
+        private Dictionary<Cell, (string sceneName, SceneType type)> cellTargets = new Dictionary<Cell, (string sceneName, SceneType type)>();
+        private List<Prefetch> prefetches = new List<Prefetch>(); // least recently hovered first
+        private HashSet<(string sceneName, SceneType type)> evicted = new HashSet<(string sceneName, SceneType type)>(); // not retried before the next scene change
+
+        /// <summary>Further targets are skipped while this many scenes are still loading</summary>
+        public const int MaxPendingPrefetches = 2;
+
+        public long MemoryBudget { get; set; } = 128 * 1024 * 1024;
+
+        protected override void DisposeManaged()
+        {
+            foreach (var prefetch in prefetches)
+                Discard(prefetch);
+            prefetches.Clear();
+        }
+
+        public void CrossInitialize(IGameSystemContainer container)
+        {
+            backend = container.Backend;
+            cellSystem = container.SystemsWith<CellSystem>().Single();
+            sceneCache = container.SceneCache;
+        }
+
+        public void OnBeforeSceneChange(LoadSceneContext context)
+        {
+            currentSceneName = context.SceneName;
+        }
+
+        public void OnAfterSceneChange()
+        {
+            cellTargets.Clear();
+            evicted.Clear();
+            foreach (var cell in cellSystem?.Cells ?? Enumerable.Empty<Cell>())
+            {
+                var target = FindTransfuseTarget(cell.Action);
+                if (target != null)
+                    cellTargets.Add(cell, target.Value);
+            }
+        }
+
+        private static (string sceneName, SceneType type)? FindTransfuseTarget(InstructionBlockNode block)
+        {
+            foreach (var instruction in block.Instructions)
+            {
+                var target = instruction switch
+                {
+                    FunctionCallNode call when TransfuseFunctions.TryGetValue(call.Function, out var type) && call.Arguments.FirstOrDefault() is StringNode sceneName =>
+                        (TrimSceneName(sceneName.Value), type),
+                    IfNode @if => FindTransfuseTarget(@if.Then) ?? (@if.Else == null ? null : FindTransfuseTarget(@if.Else)),
+                    _ => null
+                };
+                if (target != null)
+                    return target;
+            }
+            return null;
+        }
+
+        private static string TrimSceneName(string sceneName) => sceneName.StartsWith(".\\") ? sceneName.Substring(2) : sceneName;
+
+        public void Update(float timeDelta)
+        {
+            var hoveredCell = cellSystem?.HoveredCell;
+            if (hoveredCell != null && cellTargets.TryGetValue(hoveredCell, out var target))
+                Start(target.sceneName, target.type);
+            EnforceBudget();
+        }
+
+        private int IndexOf(string sceneName, SceneType type)
+        {
+            for (int i = 0; i < prefetches.Count; i++)
+            {
+                if (prefetches[i].Type == type && prefetches[i].SceneName.Equals(sceneName, StringComparison.OrdinalIgnoreCase))
+                    return i;
+            }
+            return -1;
+        }
+
+        private int PendingCount()
+        {
+            int pending = 0;
+            foreach (var prefetch in prefetches)
+            {
+                if (!prefetch.Task.IsCompleted)
+                    pending++;
+            }
+            return pending;
+        }
+
+        private void Start(string sceneName, SceneType type)
+        {
+            if (backend == null || sceneName.Equals(currentSceneName, StringComparison.OrdinalIgnoreCase) || evicted.Contains((sceneName, type)) ||
+                sceneCache?.Contains(sceneName, type) == true)
+                return;
+            Prefetch prefetch;
+            int index = IndexOf(sceneName, type);
+            if (index >= 0)
+            {
+                prefetch = prefetches[index];
+                prefetches.RemoveAt(index);
+            }
+            else
+            {
+                if (PendingCount() >= MaxPendingPrefetches)
+                    return; // started once the cell is hovered again after a load finished
+                prefetch = new Prefetch
+                {
+                    SceneName = sceneName,
+                    Type = type
+                };
+                var backend = this.backend;
+                prefetch.Task = Task.Run(() =>
+                {
+                    var context = new LoadSceneContext(backend, sceneName, type);
+                    try
+                    {
+                        context.QueueGraphicAssets();
+                        return context;
+                    }
+                    catch
+                    {
+                        context.Dispose();
+                        throw;
+                    }
+                });
+            }
+            prefetches.Add(prefetch);
+        }
+
+        private void EnforceBudget()
+        {
+            long totalSize = 0;
+            for (int i = prefetches.Count - 1; i >= 0; i--)
+            {
+                var task = prefetches[i].Task;
+                if (task.IsFaulted || task.IsCanceled)
+                {
+                    Discard(prefetches[i]);
+                    prefetches.RemoveAt(i);
+                }
+                else if (task.IsCompletedSuccessfully)
+                    totalSize += task.Result.MemorySize;
+            }
+
+            for (int i = 0; totalSize > MemoryBudget && i < prefetches.Count;)
+            {
+                var oldest = prefetches[i];
+                if (!oldest.Task.IsCompletedSuccessfully)
+                {
+                    i++; // still loading, bounded by MaxPendingPrefetches instead
+                    continue;
+                }
+                totalSize -= oldest.Task.Result.MemorySize;
+                evicted.Add((oldest.SceneName, oldest.Type));
+                Discard(oldest);
+                prefetches.RemoveAt(i);
+            }
+        }
+
+        private static void Discard(Prefetch prefetch)
+        {
+            prefetch.Task.ContinueWith(t =>
+            {
+                if (t.IsCompletedSuccessfully)
+                    t.Result.Dispose();
+                else
+                    _ = t.Exception; // the scene will report the error if it is actually loaded
+            }, TaskScheduler.Default);
+        }
+
+        /// <summary>Hands over a prefetched scene to the caller, which has to dispose the context</summary>
+        public Task<LoadSceneContext>? Take(string sceneName, SceneType type)
+        {
+            currentSceneName = TrimSceneName(sceneName); // do not prefetch it again while it is loading
+            int index = IndexOf(currentSceneName, type);
+            if (index < 0)
+                return null;
+            var prefetch = prefetches[index];
+            prefetches.RemoveAt(index);
+            return prefetch.Task;
+        }
+    }
+}
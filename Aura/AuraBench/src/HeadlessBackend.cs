@@ -0,0 +1,100 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Numerics;
+
+namespace Aura.Bench
+{
+    /// <summary>Reads all assets like a real backend but neither decodes nor renders them</summary>
+    public class HeadlessBackend : BaseDisposable, IBackend
+    {
+        private class HeadlessTexture : ITexture
+        {
+            public Vector2 Size => Vector2.Zero;
+            public void Dispose() { }
+        }
+
+        private class HeadlessVideo : HeadlessTexture, IVideoTexture
+        {
+            public bool IsLooping { get; set; }
+            public bool IsPlaying { get; private set; }
+            public void Play() => IsPlaying = true;
+            public void Pause() => IsPlaying = false;
+            public void Stop() => IsPlaying = false;
+            public event Action OnFinished { add { } remove { } }
+        }
+
+        private class HeadlessSprite : IWorldSprite
+        {
+            public bool IsEnabled { get; set; }
+            public CubeFace Face { get; set; }
+            public Vector2 Position { get; set; }
+            public ITexture? Texture { get; set; }
+            public void MarkDirty() { }
+        }
+
+        private class HeadlessWorldRenderer : IPanoramaWorldRenderer, IPuzzleWorldRenderer
+        {
+            public HeadlessWorldRenderer(int spriteCapacity)
+            {
+                Sprites = Enumerable.Range(0, spriteCapacity).Select(_ => new HeadlessSprite()).ToArray();
+            }
+
+            public Vector2 ViewportOffset { get; set; }
+            public Vector2 ViewportSize { get; set; } = IWorldRenderer.MaxViewportSize;
+            public Vector2 ViewRotation { get; set; }
+            public bool IsActive { get; set; }
+            public int Order { get; set; }
+            public long MemorySize => 0;
+            public IReadOnlyList<IWorldSprite> Sprites { get; }
+
+            public bool ConvertScreenToWorld(Vector2 screenPos, out Vector2 worldPos)
+            {
+                worldPos = screenPos;
+                return false;
+            }
+
+            public bool ConvertWorldToScreen(Vector2 worldPos, out Vector2 screenPos)
+            {
+                screenPos = worldPos;
+                return false;
+            }
+
+            public void SetViewAt(Vector2 worldPos) { }
+            public void LoadBackground(Stream stream) => stream.CopyTo(Stream.Null);
+            public void Dispose() { }
+        }
+
+        public VirtualFileSystem FileSystem { get; } = new VirtualFileSystem();
+        public string? CachePath { get; set; }
+        public Vector2 CursorPosition { get; set; }
+        public event Action<Vector2> OnClick { add { } remove { } }
+        public event Action<Vector2> OnViewDrag { add { } remove { } }
+
+        protected override void DisposeManaged()
+        {
+            FileSystem.Dispose();
+        }
+
+        public ITexture CreateImage(Stream stream)
+        {
+            stream.CopyTo(Stream.Null);
+            return new HeadlessTexture();
+        }
+
+        public IVideoTexture CreateVideo(Stream stream)
+        {
+            stream.Dispose();
+            return new HeadlessVideo();
+        }
+
+        public IPanoramaWorldRenderer CreatePanoramaRenderer(Stream stream, int spriteCapacity)
+        {
+            stream.CopyTo(Stream.Null);
+            return new HeadlessWorldRenderer(spriteCapacity);
+        }
+
+        public IPuzzleWorldRenderer CreatePuzzleRenderer(int spriteCapacity) => new HeadlessWorldRenderer(spriteCapacity);
+    }
+}
@@ -0,0 +1,140 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Text.Json;
+
+namespace Aura.Bench
+{
+    class Program
+    {
+        static int Main(string[] argArray)
+        {
+            var args = argArray.ToList();
+            try
+            {
+                var outputPath = TakeOption(args, "--output");
+                var iterationsOption = TakeOption(args, "--iterations");
+                int iterations = 1;
+                if (iterationsOption != null && (!int.TryParse(iterationsOption, out iterations) || iterations < 1))
+                    throw new ArgumentException($"Invalid iteration count {iterationsOption}");
+                if (outputPath == null || args.Count < 1 || args.Any(a => a.StartsWith("--")))
+                    return PrintUsage();
+
+                // not to standard output, the engine writes its diagnostics there
+                using var output = new FileStream(outputPath, FileMode.Create, FileAccess.Write);
+                Run(args[0], args.Skip(1).ToArray(), iterations, output);
+                return 0;
+            }
+            catch (ArgumentException e)
+            {
+                Console.Error.WriteLine($"Error: {e.Message}");
+                return PrintUsage();
+            }
+            catch (Exception e) when (e is IOException || e is InvalidDataException || e is UnauthorizedAccessException)
+            {
+                Console.Error.WriteLine($"Error: {e.Message}");
+                return 1;
+            }
+        }
+
+        static int PrintUsage()
+        {
+            Console.Error.WriteLine("usage: AuraBench --output <file> [--iterations <count>] <game directory> [scene...]");
+            Console.Error.WriteLine("  loads every scene as panorama and as puzzle without rendering and writes the");
+            Console.Error.WriteLine("  wall time and allocated bytes of every loading phase as JSON into <file>");
+            return 2;
+        }
+
+        static string? TakeOption(List<string> args, string name)
+        {
+            int index = args.IndexOf(name);
+            if (index < 0)
+                return null;
+            if (index + 1 >= args.Count)
+                throw new ArgumentException($"Missing value for {name}");
+            var value = args[index + 1];
+            args.RemoveRange(index, 2);
+            return value;
+        }
+
+        static IEnumerable<string> FindScenes(string gameDir, IReadOnlyCollection<string> sceneFilter)
+        {
+            var scenesDir = Path.Combine(gameDir, "Scenes");
+            if (!Directory.Exists(scenesDir))
+                throw new DirectoryNotFoundException($"Could not find scene directory {scenesDir}");
+            return Directory.GetDirectories(scenesDir)
+                .Select(Path.GetFileName)
+                .Select(n => n!)
+                .Where(n => sceneFilter.Count == 0 || sceneFilter.Contains(n, StringComparer.OrdinalIgnoreCase))
+                .OrderBy(n => n, StringComparer.OrdinalIgnoreCase);
+        }
+
+        static void Run(string gameDir, IReadOnlyCollection<string> sceneFilter, int iterations, Stream output)
+        {
+            var scenes = FindScenes(gameDir, sceneFilter).ToArray();
+            using var backend = new HeadlessBackend();
+            backend.FileSystem.MountGameDirectory(gameDir);
+            var game = new Game(backend);
+            game.SceneCache.MemoryBudget = 0; // every load has to start from scratch
+            var profiler = new LoadProfiler();
+            game.LoadProfiler = profiler;
+
+            using var writer = new Utf8JsonWriter(output, new JsonWriterOptions() { Indented = true });
+            writer.WriteStartObject();
+            writer.WriteString("gameDirectory", Path.GetFullPath(gameDir));
+            writer.WriteString("runtime", Environment.Version.ToString());
+            writer.WriteNumber("processorCount", Environment.ProcessorCount);
+            writer.WriteStartArray("loads");
+            foreach (var sceneName in scenes)
+            {
+                foreach (var type in Enum.GetValues<SceneType>())
+                {
+                    for (int iteration = 0; iteration < iterations; iteration++)
+                    {
+                        GC.Collect();
+                        GC.WaitForPendingFinalizers();
+                        profiler.Reset();
+                        string? error = null;
+                        long allocatedBefore = GC.GetTotalAllocatedBytes(precise: true);
+                        var stopwatch = Stopwatch.StartNew();
+                        try
+                        {
+                            game.LoadScene(sceneName, type);
+                        }
+                        catch (Exception e)
+                        {
+                            error = e.Message; // e.g. panorama scenes loaded as puzzle, the other phases are still reported
+                        }
+                        stopwatch.Stop();
+                        long allocatedBytes = GC.GetTotalAllocatedBytes(precise: true) - allocatedBefore;
+                        Console.Error.WriteLine($"{sceneName} {type}: {stopwatch.Elapsed.TotalMilliseconds:F2}ms{(error == null ? "" : " (failed)")}");
+
+                        writer.WriteStartObject();
+                        writer.WriteString("scene", sceneName);
+                        writer.WriteString("type", type.ToString());
+                        writer.WriteNumber("iteration", iteration);
+                        writer.WriteNumber("totalMs", stopwatch.Elapsed.TotalMilliseconds);
+                        writer.WriteNumber("allocatedBytes", allocatedBytes);
+                        writer.WriteStartObject("phases");
+                        foreach (var (phase, stats) in profiler.Phases)
+                        {
+                            writer.WriteStartObject(phase.ToString());
+                            writer.WriteNumber("ms", stats.Time.TotalMilliseconds);
+                            writer.WriteNumber("allocatedBytes", stats.AllocatedBytes);
+                            writer.WriteNumber("count", stats.Count);
+                            writer.WriteEndObject();
+                        }
+                        writer.WriteEndObject();
+                        if (error != null)
+                            writer.WriteString("error", error);
+                        writer.WriteEndObject();
+                    }
+                }
+            }
+            writer.WriteEndArray();
+            writer.WriteEndObject();
+        }
+    }
+}
@@ -38,6 +38,7 @@ namespace Aura.Veldrid
         };
 
         private GraphicsDevice graphicsDevice;
+        private GpuResourcePool resourcePool;
         public DeviceBuffer vertexBuffer;
         public DeviceBuffer indexBuffer;
         public DeviceBuffer uniformBuffer;
@@ -72,6 +73,7 @@ namespace Aura.Veldrid
                 SetViewport();
             }
         }
+        /// <summary>The cubemap to show, it is not owned by the panorama</summary>
         public Texture? Texture
         {
             get => texture;
@@ -79,8 +81,6 @@ namespace Aura.Veldrid
             {
                 if (value == null)
                     throw new ArgumentNullException(nameof(value));
-                if (texture != null)
-                    texture.Dispose();
                 texture = value;
                 if (resourceSet != null)
                     resourceSet.Dispose();
@@ -108,28 +108,33 @@ namespace Aura.Veldrid
             }
         }
 
-        public CubemapPanorama(GraphicsDevice gd, Framebuffer fb)
+        public CubemapPanorama(GpuResourcePool pool, Framebuffer fb)
         {
-            graphicsDevice = gd;
+            resourcePool = pool;
+            graphicsDevice = pool.Device;
             framebuffer = fb;
             SetViewport();
 
-            resourceLayout = gd.ResourceFactory.CreateResourceLayout(resourceLayoutDescr);
-            shaders = gd.ResourceFactory.LoadShadersFromFiles(ShaderName);
+            resourceLayout = pool.GetResourceLayout(resourceLayoutDescr);
+            shaders = pool.GetShaders(ShaderName);
             pipeline = CreatePipeline();
 
-            vertexBuffer = graphicsDevice.CreateBufferFrom(BufferUsage.VertexBuffer,
+            vertexBuffer = pool.RentBuffer(new BufferDescription(4 * 2 * sizeof(float), BufferUsage.VertexBuffer));
+            graphicsDevice.UpdateBuffer(vertexBuffer, 0, new[]
+            {
                 new Vector2(-1f, 1f),
                 new Vector2(1f, 1f),
                 new Vector2(-1f, -1f),
-                new Vector2(1f, -1f));
-            indexBuffer = graphicsDevice.CreateBufferFrom<ushort>(BufferUsage.IndexBuffer, 0, 1, 2, 3);
-            uniformBuffer = gd.ResourceFactory.CreateBuffer(new BufferDescription(
+                new Vector2(1f, -1f)
+            });
+            indexBuffer = pool.RentBuffer(new BufferDescription(4 * sizeof(ushort), BufferUsage.IndexBuffer));
+            graphicsDevice.UpdateBuffer(indexBuffer, 0, new ushort[] { 0, 1, 2, 3 });
+            uniformBuffer = pool.RentBuffer(new BufferDescription(
                 usage: BufferUsage.UniformBuffer,
                 sizeInBytes: 2 * 4 * 4 * sizeof(float)));
             ViewRotation = Vector2.Zero; // initialise view matrix
 
-            sampler = gd.ResourceFactory.CreateSampler(new SamplerDescription
+            sampler = pool.GetSampler(new SamplerDescription
             {
                 AddressModeU = SamplerAddressMode.Clamp,
                 AddressModeV = SamplerAddressMode.Clamp,
@@ -140,18 +145,11 @@ namespace Aura.Veldrid
 
         protected override void DisposeManaged()
         {
-            vertexBuffer.Dispose();
-            indexBuffer.Dispose();
-            uniformBuffer.Dispose();
-            foreach (var shader in shaders)
-                shader.Dispose();
+            resourcePool.Return(vertexBuffer);
+            resourcePool.Return(indexBuffer);
+            resourcePool.Return(uniformBuffer);
             if (resourceSet != null)
                 resourceSet.Dispose();
-            sampler.Dispose();
-            pipeline.Dispose();
-            resourceLayout.Dispose();
-            if (Texture != null)
-                Texture.Dispose();
         }
 
         public void Render(CommandList commandList)
@@ -207,7 +205,7 @@ namespace Aura.Veldrid
                     shaders: shaders),
                 resourceLayout: resourceLayout,
                 outputs: Framebuffer.OutputDescription);
-            return graphicsDevice.ResourceFactory.CreateGraphicsPipeline(ref pipelineDescr);
+            return resourcePool.GetPipeline(pipelineDescr);
         }
 
         public bool ConvertMouseToAura(Vector2 mouse, out Vector2 worldPos)
@@ -0,0 +1,208 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Veldrid;
+
+namespace Aura.Veldrid
+{
+    /// <summary>Recycles the GPU resources of world renderers across scene changes</summary>
+    /// <remarks>
+    /// Textures, buffers and command lists are rented and returned, returned ones are kept in LRU order
+    /// until they exceed <see cref="IdleBudget"/>. Shaders, layouts, samplers, pipelines and framebuffers
+    /// of pooled textures are immutable and shared, they must not be disposed by the caller.
+    /// All methods may be called from background threads.
+    /// </remarks>
+    public class GpuResourcePool : BaseDisposable
+    {
+        private const int DefaultIdleBudget = 64 * 1024 * 1024;
+
+        private class IdleResource
+        {
+            public object Description = null!;
+            public IDisposable Resource = null!;
+            public long SizeInBytes;
+        }
+
+        private readonly object poolLock = new object();
+        private readonly Dictionary<IDisposable, object> rented = new Dictionary<IDisposable, object>();
+        private readonly LinkedList<IdleResource> idle = new LinkedList<IdleResource>(); // least recently returned first
+        private readonly Dictionary<(Texture, uint), Framebuffer> framebuffers = new Dictionary<(Texture, uint), Framebuffer>();
+        private readonly Dictionary<string, Shader[]> shaders = new Dictionary<string, Shader[]>();
+        private readonly Dictionary<ResourceLayoutDescription, ResourceLayout> resourceLayouts = new Dictionary<ResourceLayoutDescription, ResourceLayout>();
+        private readonly Dictionary<SamplerDescription, Sampler> samplers = new Dictionary<SamplerDescription, Sampler>();
+        private readonly Dictionary<GraphicsPipelineDescription, Pipeline> pipelines = new Dictionary<GraphicsPipelineDescription, Pipeline>();
+        private long idleBytes = 0;
+        private long idleBudget = DefaultIdleBudget;
+
+        public GraphicsDevice Device { get; }
+        public ResourceFactory Factory => Device.ResourceFactory;
+
+        public long IdleBudget
+        {
+            get => idleBudget;
+            set
+            {
+                lock (poolLock)
+                {
+                    idleBudget = value;
+                    TrimIdle();
+                }
+            }
+        }
+
+        public GpuResourcePool(GraphicsDevice device)
+        {
+            Device = device;
+        }
+
+        protected override void DisposeManaged()
+        {
+            lock (poolLock)
+            {
+                foreach (var resource in idle)
+                    DisposeResource(resource.Resource);
+                idle.Clear();
+                idleBytes = 0;
+                foreach (var resource in rented.Keys)
+                    DisposeResource(resource);
+                rented.Clear();
+                foreach (var shader in shaders.Values.SelectMany(s => s))
+                    shader.Dispose();
+                foreach (var pipeline in pipelines.Values)
+                    pipeline.Dispose();
+                foreach (var resourceLayout in resourceLayouts.Values)
+                    resourceLayout.Dispose();
+                foreach (var sampler in samplers.Values)
+                    sampler.Dispose();
+                shaders.Clear();
+                pipelines.Clear();
+                resourceLayouts.Clear();
+                samplers.Clear();
+            }
+        }
+
+        public Texture RentTexture(TextureDescription description) =>
+            Rent(description, () => Factory.CreateTexture(description));
+
+        public DeviceBuffer RentBuffer(BufferDescription description) =>
+            Rent(description, () => Factory.CreateBuffer(description));
+
+        /// <summary>Rents a command list which is not recording</summary>
+        public CommandList RentCommandList() =>
+            Rent(typeof(CommandList), () => Factory.CreateCommandList());
+
+        private T Rent<T>(object description, Func<T> create) where T : class, IDisposable
+        {
+            lock (poolLock)
+            {
+                for (var node = idle.Last; node != null; node = node.Previous)
+                {
+                    if (!node.Value.Description.Equals(description))
+                        continue;
+                    idle.Remove(node);
+                    idleBytes -= node.Value.SizeInBytes;
+                    rented.Add(node.Value.Resource, description);
+                    return (T)node.Value.Resource;
+                }
+            }
+            var resource = create();
+            lock (poolLock)
+                rented.Add(resource, description);
+            return resource;
+        }
+
+        /// <summary>Returns a rented resource to the pool, its content is undefined when it is rented again</summary>
+        public void Return(IDisposable resource)
+        {
+            lock (poolLock)
+            {
+                if (!rented.Remove(resource, out var description))
+                    throw new InvalidOperationException("Resource was not rented from this pool");
+                var idleResource = new IdleResource
+                {
+                    Description = description,
+                    Resource = resource,
+                    SizeInBytes = resource switch
+                    {
+                        Texture texture => texture.GetSizeInBytes(),
+                        DeviceBuffer buffer => buffer.SizeInBytes,
+                        _ => 0
+                    }
+                };
+                idle.AddLast(idleResource);
+                idleBytes += idleResource.SizeInBytes;
+                TrimIdle();
+            }
+        }
+
+        private void TrimIdle()
+        {
+            while (idleBytes > idleBudget && idle.First != null)
+            {
+                var resource = idle.First.Value;
+                idle.RemoveFirst();
+                idleBytes -= resource.SizeInBytes;
+                DisposeResource(resource.Resource);
+            }
+        }
+
+        private void DisposeResource(IDisposable resource)
+        {
+            if (resource is Texture texture)
+            {
+                foreach (var key in framebuffers.Keys.Where(k => k.Item1 == texture).ToArray())
+                {
+                    framebuffers[key].Dispose();
+                    framebuffers.Remove(key);
+                }
+            }
+            resource.Dispose();
+        }
+
+        /// <summary>Gets a framebuffer rendering into an array layer of a pooled texture</summary>
+        public Framebuffer GetFramebuffer(Texture target, uint arrayLayer)
+        {
+            lock (poolLock)
+            {
+                if (!rented.ContainsKey(target))
+                    throw new InvalidOperationException("Framebuffers are only shared for rented textures");
+                if (framebuffers.TryGetValue((target, arrayLayer), out var framebuffer))
+                    return framebuffer;
+                framebuffer = Factory.CreateFramebuffer(new FramebufferDescription
+                {
+                    ColorTargets = new FramebufferAttachmentDescription[]
+                    {
+                        new FramebufferAttachmentDescription(target, arrayLayer)
+                    }
+                });
+                framebuffers.Add((target, arrayLayer), framebuffer);
+                return framebuffer;
+            }
+        }
+
+        public Shader[] GetShaders(string shaderName) =>
+            GetShared(shaders, shaderName, () => Factory.LoadShadersFromFiles(shaderName));
+
+        public ResourceLayout GetResourceLayout(ResourceLayoutDescription description) =>
+            GetShared(resourceLayouts, description, () => Factory.CreateResourceLayout(description));
+
+        public Sampler GetSampler(SamplerDescription description) =>
+            GetShared(samplers, description, () => Factory.CreateSampler(description));
+
+        public Pipeline GetPipeline(GraphicsPipelineDescription description) =>
+            GetShared(pipelines, description, () => Factory.CreateGraphicsPipeline(description));
+
+        private TValue GetShared<TKey, TValue>(Dictionary<TKey, TValue> cache, TKey key, Func<TValue> create) where TKey : notnull
+        {
+            lock (poolLock)
+            {
+                if (!cache.TryGetValue(key, out var value))
+                {
+                    value = create();
+                    cache.Add(key, value);
+                }
+                return value;
+            }
+        }
+    }
+}
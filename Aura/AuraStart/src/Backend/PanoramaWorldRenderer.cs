@@ -11,6 +11,7 @@ namespace Aura.Veldrid
         private const uint FaceCount = 6;
 
         private GraphicsDevice device;
+        private GpuResourcePool resourcePool;
         private CubemapPanorama panorama;
         private Texture cubemap;
         private SpriteRenderer[] spriteRenderers = new SpriteRenderer[FaceCount];
@@ -43,8 +44,9 @@ namespace Aura.Veldrid
         public PanoramaWorldRenderer(int spriteCapacity, SpriteRendererCommon common, Framebuffer framebuffer)
         {
             device = common.Device;
+            resourcePool = common.ResourcePool;
             uint worldResolution = Math.Max(framebuffer.Width, framebuffer.Height);
-            cubemap = common.Factory.CreateTexture(new TextureDescription
+            cubemap = resourcePool.RentTexture(new TextureDescription
             {
                 Width = worldResolution,
                 Height = worldResolution,
@@ -55,7 +57,7 @@ namespace Aura.Veldrid
                 Type = TextureType.Texture2D,
                 Usage = TextureUsage.Sampled | TextureUsage.RenderTarget
             });
-            panorama = new CubemapPanorama(device, framebuffer);
+            panorama = new CubemapPanorama(resourcePool, framebuffer);
             panorama.Texture = cubemap;
             for (uint i = 0; i < FaceCount; i++)
                 spriteRenderers[i] = new SpriteRenderer(common, spriteCapacity, cubemap, (CubeFace)i);
@@ -67,9 +69,9 @@ namespace Aura.Veldrid
         protected override void DisposeManaged()
         {
             panorama.Dispose();
-            cubemap.Dispose();
             foreach (var spriteRenderer in spriteRenderers)
                 spriteRenderer.Dispose();
+            resourcePool.Return(cubemap);
             foreach (var sprite in sprites)
                 sprite.Dispose();
             worldRendererSet?.Remove(this);
@@ -105,6 +107,7 @@ namespace Aura.Veldrid
 
         public bool IsActive { get; set; } = true;
         public int Order { get; set; } = 0;
+        public long MemorySize => cubemap.GetSizeInBytes() + (worldTexture?.GetSizeInBytes() ?? 0);
 
         public IReadOnlyList<IWorldSprite> Sprites => sprites;
 
@@ -11,6 +11,7 @@ namespace Aura.Veldrid
     {
         private Viewport viewport;
         private GraphicsDevice device;
+        private GpuResourcePool resourcePool;
         private WorldRendererSet? worldRendererSet = null;
         private SpriteRenderer spriteRenderer;
         private WorldSprite[] sprites;
@@ -42,6 +43,7 @@ namespace Aura.Veldrid
         }
         public bool IsActive { get; set; } = true;
         public int Order { get; set; } = 0;
+        public long MemorySize => texture.GetSizeInBytes() + (spriteRenderer.WorldTexture?.GetSizeInBytes() ?? 0);
         public Matrix4x4 ProjectionMatrix => Matrix4x4.Identity;
         public Matrix4x4 ViewMatrix => Matrix4x4.Identity;
         public WorldRendererSet? WorldRendererSet
@@ -62,8 +64,9 @@ namespace Aura.Veldrid
             viewport = new Viewport(0.0f, 0.0f, framebuffer.Width, framebuffer.Height, -10.0f, 10.0f);
             device = spriteRendererCommon.Device;
             this.framebuffer = framebuffer;
+            resourcePool = spriteRendererCommon.ResourcePool;
             var factory = device.ResourceFactory;
-            texture = factory.CreateTexture(new TextureDescription(
+            texture = resourcePool.RentTexture(new TextureDescription(
                 width: framebuffer.Width,
                 height: framebuffer.Height,
                 depth: 1,
@@ -77,15 +80,15 @@ namespace Aura.Veldrid
                 .Range(0, spriteCapacity)
                 .Select(i => new WorldSprite(new SpriteRenderer[] { spriteRenderer }, i))
                 .ToArray();
-            vertexBuffer = factory.CreateBuffer(new BufferDescription(4 * 2 * sizeof(float), BufferUsage.VertexBuffer));
+            vertexBuffer = resourcePool.RentBuffer(new BufferDescription(4 * 2 * sizeof(float), BufferUsage.VertexBuffer));
             device.UpdateBuffer(vertexBuffer, 0, new[] { new Vector2(-1, -1), new Vector2(+1, -1), new Vector2(-1, +1), new Vector2(+1, +1) });
-            resourceLayout = factory.CreateResourceLayout(new ResourceLayoutDescription(
+            resourceLayout = resourcePool.GetResourceLayout(new ResourceLayoutDescription(
                 new ResourceLayoutElementDescription("MainTexture", ResourceKind.TextureReadOnly, ShaderStages.Fragment),
                 new ResourceLayoutElementDescription("MainTextureSampler", ResourceKind.Sampler, ShaderStages.Fragment)));
             resourceSet = factory.CreateResourceSet(new ResourceSetDescription(resourceLayout, texture, device.LinearSampler));
-            shaders = factory.LoadShadersFromFiles("Blit");
+            shaders = resourcePool.GetShaders("Blit");
             var vertexLayout = new VertexLayoutDescription(new VertexElementDescription("Pos", VertexElementFormat.Float2, VertexElementSemantic.Position));
-            pipeline = factory.CreateGraphicsPipeline(new GraphicsPipelineDescription(
+            pipeline = resourcePool.GetPipeline(new GraphicsPipelineDescription(
                 BlendStateDescription.SingleAlphaBlend,
                 DepthStencilStateDescription.Disabled,
                 RasterizerStateDescription.CullNone,
@@ -104,13 +107,9 @@ namespace Aura.Veldrid
             spriteRenderer.Dispose();
             foreach (var sprite in sprites)
                 sprite.Dispose();
-            texture.Dispose();
-            vertexBuffer.Dispose();
-            resourceLayout.Dispose();
             resourceSet.Dispose();
-            foreach (var shader in shaders)
-                shader.Dispose();
-            pipeline.Dispose();
+            resourcePool.Return(texture);
+            resourcePool.Return(vertexBuffer);
         }
 
         public bool ConvertScreenToWorld(Vector2 screenPos, out Vector2 worldPos)
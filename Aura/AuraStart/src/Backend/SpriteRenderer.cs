@@ -13,7 +13,7 @@ namespace Aura.Veldrid
         private CommandList commandList;
         private Framebuffer framebuffer;
         private ResourceSet?[] spriteResourceSets;
-        private QuadIndexBuffer indexBuffer;
+        private QuadIndexBuffer indexBuffer; // shared, not owned
         private DeviceBuffer vertexBuffer;
         private Matrix4x4 ProjectionMatrix;
         private Vertex[] vertices = new Vertex[0];
@@ -59,35 +59,30 @@ namespace Aura.Veldrid
             Target = target;
             TargetFace = targetFace;
 
-            commandList = common.Factory.CreateCommandList();
+            var pool = common.ResourcePool;
+            commandList = pool.RentCommandList();
             Fence = common.Factory.CreateFence(true);
-            framebuffer = common.Factory.CreateFramebuffer(new FramebufferDescription
-            {
-                ColorTargets = new FramebufferAttachmentDescription[]
-                {
-                    new FramebufferAttachmentDescription(Target, (uint)TargetFace)
-                }
-            });
+            framebuffer = pool.GetFramebuffer(Target, (uint)TargetFace);
 
             spriteCapacity++; // reserve first for world texture
             spriteResourceSets = Enumerable.Repeat<ResourceSet?>(null, spriteCapacity).ToArray();
-            indexBuffer = new QuadIndexBuffer(common.Device, spriteCapacity);
-            vertexBuffer = common.Factory.CreateBuffer(new BufferDescription(
-                sizeInBytes: (uint)(spriteCapacity * 4 * Vertex.SizeInBytes),
+            indexBuffer = common.GetQuadIndexBuffer(spriteCapacity);
+            vertexBuffer = pool.RentBuffer(new BufferDescription(
+                sizeInBytes: (uint)(SpriteRendererCommon.RoundCapacity(spriteCapacity) * 4 * Vertex.SizeInBytes),
                 usage: BufferUsage.VertexBuffer));
             vertices = new Vertex[spriteCapacity * 4];
-            UniformBuffer = common.Factory.CreateBuffer(
+            UniformBuffer = pool.RentBuffer(
                 new BufferDescription(4 * 4 * sizeof(float), BufferUsage.UniformBuffer));
             WorldTexture = null;
         }
 
         protected override void DisposeManaged()
         {
-            commandList.Dispose();
-            framebuffer.Dispose();
-            indexBuffer.Dispose();
-            vertexBuffer.Dispose();
-            UniformBuffer.Dispose();
+            var pool = Common.ResourcePool;
+            pool.Return(commandList);
+            pool.Return(vertexBuffer);
+            pool.Return(UniformBuffer);
+            Fence.Dispose();
             spriteResourceSets[0]?.Dispose();
             worldTextureView?.Dispose();
         }
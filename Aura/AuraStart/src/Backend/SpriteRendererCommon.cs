@@ -41,43 +41,61 @@ namespace Aura.Veldrid
             }
         }
 
-        public GraphicsDevice Device { get; }
+        public GraphicsDevice Device => ResourcePool.Device;
         public ResourceFactory Factory => Device.ResourceFactory;
+        public GpuResourcePool ResourcePool { get; }
         public Sampler PointSampler { get; }
         public ResourceLayout ResourceLayout { get; }
 
         private Shader[] spriteShaders;
-        private Dictionary<PixelFormat, Pipeline> pipelines = new Dictionary<PixelFormat, Pipeline>();
+        private Dictionary<int, QuadIndexBuffer> indexBuffers = new Dictionary<int, QuadIndexBuffer>();
 
-        public SpriteRendererCommon(GraphicsDevice device)
+        public SpriteRendererCommon(GpuResourcePool resourcePool)
         {
-            Device = device;
-            PointSampler = Factory.CreateSampler(new SamplerDescription
+            ResourcePool = resourcePool;
+            PointSampler = resourcePool.GetSampler(new SamplerDescription
             {
                 AddressModeU = SamplerAddressMode.Clamp,
                 AddressModeV = SamplerAddressMode.Clamp,
                 AddressModeW = SamplerAddressMode.Clamp,
                 Filter = SamplerFilter.MinPoint_MagPoint_MipPoint
             });
-            ResourceLayout = Factory.CreateResourceLayout(resourceLayoutDescr);
-            spriteShaders = Factory.LoadShadersFromFiles("sprite");
+            ResourceLayout = resourcePool.GetResourceLayout(resourceLayoutDescr);
+            spriteShaders = resourcePool.GetShaders("sprite");
         }
 
         protected override void DisposeManaged()
         {
-            PointSampler.Dispose();
-            ResourceLayout.Dispose();
-            foreach (var shader in spriteShaders)
-                shader.Dispose();
-            foreach (var pipeline in pipelines.Values)
-                pipeline.Dispose();
+            foreach (var indexBuffer in indexBuffers.Values)
+                indexBuffer.Dispose();
         }
 
-        public Pipeline GetPipeline(PixelFormat framebufferFormat)
+        /// <summary>Rounds a sprite capacity up so that pooled buffers fit more scenes</summary>
+        public static int RoundCapacity(int spriteCapacity)
         {
-            if (pipelines.TryGetValue(framebufferFormat, out var pipeline))
-                return pipeline;
+            int capacity = 16;
+            while (capacity < spriteCapacity)
+                capacity *= 2;
+            return capacity;
+        }
 
+        /// <summary>Gets an index buffer shared by all sprite renderers with the same rounded capacity</summary>
+        public QuadIndexBuffer GetQuadIndexBuffer(int quadCapacity)
+        {
+            quadCapacity = RoundCapacity(quadCapacity);
+            lock (indexBuffers)
+            {
+                if (!indexBuffers.TryGetValue(quadCapacity, out var indexBuffer))
+                {
+                    indexBuffer = new QuadIndexBuffer(Device, quadCapacity);
+                    indexBuffers.Add(quadCapacity, indexBuffer);
+                }
+                return indexBuffer;
+            }
+        }
+
+        public Pipeline GetPipeline(PixelFormat framebufferFormat)
+        {
             var pipelineDescr = new GraphicsPipelineDescription(
                 blendState: BlendStateDescription.SingleAlphaBlend,
                 depthStencilStateDescription: DepthStencilStateDescription.Disabled,
@@ -90,9 +108,7 @@ namespace Aura.Veldrid
                 outputs: new OutputDescription(
                     depthAttachment: null,
                     new OutputAttachmentDescription(framebufferFormat)));
-            pipeline = Factory.CreateGraphicsPipeline(ref pipelineDescr);
-            pipelines.Add(framebufferFormat, pipeline);
-            return pipeline;
+            return ResourcePool.GetPipeline(pipelineDescr);
         }
     }
 }
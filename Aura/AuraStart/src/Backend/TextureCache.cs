@@ -0,0 +1,181 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Security.Cryptography;
+using System.Threading.Tasks;
+using Veldrid;
+
+namespace Aura.Veldrid
+{
+    /// <summary>Shares textures decoded from byte-identical images</summary>
+    /// <remarks>
+    /// Every acquisition returns its own handle, the texture is released once all handles are disposed.
+    /// Released textures are kept in LRU order until they exceed <see cref="ReleasedBudget"/> so that
+    /// neighbouring scenes can reuse them.
+    /// </remarks>
+    public class TextureCache : BaseDisposable
+    {
+        private class Entry
+        {
+            public string Key = "";
+            public Texture Texture = null!;
+            public int RefCount;
+            public long SizeInBytes;
+            public LinkedListNode<Entry>? ReleasedNode;
+        }
+
+        private class CachedTexture : AuraTexture
+        {
+            private readonly TextureCache parent;
+            private readonly Entry entry;
+
+            public CachedTexture(TextureCache parent, Entry entry) : base(entry.Texture, ownsTexture: false)
+            {
+                this.parent = parent;
+                this.entry = entry;
+            }
+
+            protected override void DisposeManaged() => parent.Release(entry);
+        }
+
+        private readonly object cacheLock = new object();
+        private readonly GraphicsDevice device;
+        private readonly Dictionary<string, Entry> entries = new Dictionary<string, Entry>();
+        private readonly LinkedList<Entry> released = new LinkedList<Entry>();
+        private long releasedBytes = 0;
+        private long releasedBudget = 64 * 1024 * 1024;
+
+        public long ReleasedBudget
+        {
+            get => releasedBudget;
+            set
+            {
+                lock (cacheLock)
+                {
+                    releasedBudget = value;
+                    TrimReleased();
+                }
+            }
+        }
+
+        public TextureCache(GraphicsDevice device)
+        {
+            this.device = device;
+        }
+
+        protected override void DisposeManaged()
+        {
+            lock (cacheLock)
+            {
+                foreach (var entry in entries.Values)
+                    entry.Texture.Dispose();
+                entries.Clear();
+                released.Clear();
+                releasedBytes = 0;
+            }
+        }
+
+        public AuraTexture Acquire(Stream stream) => AcquireAll(new[] { stream }).Single();
+
+        /// <summary>Decodes all uncached images in parallel and uploads them together</summary>
+        public IReadOnlyList<AuraTexture> AcquireAll(IReadOnlyList<Stream> streams)
+        {
+            var contents = new MemoryStream[streams.Count];
+            var keys = new string[streams.Count];
+            for (int i = 0; i < streams.Count; i++)
+            {
+                contents[i] = new MemoryStream();
+                streams[i].CopyTo(contents[i]);
+                keys[i] = Convert.ToHexString(SHA256.HashData(contents[i].GetBuffer().AsSpan(0, (int)contents[i].Length)));
+            }
+
+            var results = new AuraTexture[streams.Count];
+            try
+            {
+                var missing = new List<int>();
+                lock (cacheLock)
+                {
+                    for (int i = 0; i < keys.Length; i++)
+                    {
+                        if (entries.TryGetValue(keys[i], out var entry))
+                            results[i] = AddReference(entry);
+                        else
+                            missing.Add(i);
+                    }
+                }
+                if (missing.Count == 0)
+                    return results;
+
+                var toDecode = missing.GroupBy(i => keys[i]).Select(g => g.First()).ToArray();
+                var decoded = new DecodedImage[toDecode.Length];
+                Parallel.For(0, toDecode.Length, i => decoded[i] = ImageLoader.DecodeImage(contents[toDecode[i]]));
+                var textures = ImageLoader.UploadImages(decoded, device);
+                lock (cacheLock)
+                {
+                    for (int i = 0; i < toDecode.Length; i++)
+                    {
+                        var key = keys[toDecode[i]];
+                        if (entries.ContainsKey(key))
+                            textures[i].Dispose(); // another thread was faster
+                        else
+                        {
+                            entries.Add(key, new Entry
+                            {
+                                Key = key,
+                                Texture = textures[i],
+                                SizeInBytes = (long)textures[i].Width * textures[i].Height * 4
+                            });
+                        }
+                    }
+                    foreach (var i in missing)
+                        results[i] = AddReference(entries[keys[i]]);
+                }
+                return results;
+            }
+            catch
+            {
+                foreach (var result in results)
+                    result?.Dispose();
+                throw;
+            }
+        }
+
+        private AuraTexture AddReference(Entry entry)
+        {
+            if (entry.ReleasedNode != null)
+            {
+                released.Remove(entry.ReleasedNode);
+                entry.ReleasedNode = null;
+                releasedBytes -= entry.SizeInBytes;
+            }
+            entry.RefCount++;
+            return new CachedTexture(this, entry);
+        }
+
+        private void Release(Entry entry)
+        {
+            lock (cacheLock)
+            {
+                if (--entry.RefCount > 0 || !entries.ContainsKey(entry.Key))
+                    return;
+                entry.ReleasedNode = released.AddLast(entry);
+                releasedBytes += entry.SizeInBytes;
+                TrimReleased();
+            }
+        }
+
+        private void TrimReleased()
+        {
+            while (releasedBytes > releasedBudget && released.First != null)
+            {
+                var entry = released.First.Value;
+                released.RemoveFirst();
+                entry.ReleasedNode = null;
+                releasedBytes -= entry.SizeInBytes;
+                entries.Remove(entry.Key);
+                entry.Texture.Dispose();
+            }
+        }
+    }
+}
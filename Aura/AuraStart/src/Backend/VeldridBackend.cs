@@ -37,18 +37,22 @@ namespace Aura.Veldrid
     {
         public Sdl2Window Window { get; }
         public GraphicsDevice Device { get; }
+        public GpuResourcePool ResourcePool { get; }
         public SpriteRendererCommon SpriteRendererCommon { get; }
         public VideoTextureSet VideoTextureSet { get; }
         public WorldRendererSet WorldRendererSet { get; }
+        public TextureCache TextureCache { get; }
         public ResourceFactory Factory => Device.ResourceFactory;
 
         public VeldridBackend(Sdl2Window window, GraphicsDevice device)
         {
             this.Window = window;
             this.Device = device;
-            SpriteRendererCommon = new SpriteRendererCommon(device);
+            ResourcePool = new GpuResourcePool(device);
+            SpriteRendererCommon = new SpriteRendererCommon(ResourcePool);
             VideoTextureSet = new VideoTextureSet(device);
             WorldRendererSet = new WorldRendererSet(device);
+            TextureCache = new TextureCache(device);
 
             window.MouseMove += HandleMouseMove;
             window.MouseDown += HandleMouseDown;
@@ -58,6 +62,9 @@ namespace Aura.Veldrid
         {
             SpriteRendererCommon.Dispose();
             VideoTextureSet.Dispose();
+            TextureCache.Dispose();
+            ResourcePool.Dispose();
+            FileSystem.Dispose();
         }
 
         public void Update(float timeDelta)
@@ -72,7 +79,22 @@ namespace Aura.Veldrid
         }
 
         public InputSnapshot? CurrentInput { get; set; }
-        public string? AssetPath { get; set; }
+        public VirtualFileSystem FileSystem { get; } = new VirtualFileSystem();
+
+        private string? assetPath;
+        public string? AssetPath
+        {
+            get => assetPath;
+            set
+            {
+                if (assetPath != null)
+                    throw new InvalidOperationException("The asset path cannot be changed once it is mounted");
+                assetPath = value;
+                if (value != null)
+                    FileSystem.MountGameDirectory(value);
+            }
+        }
+        public string? CachePath { get; set; }
 
         public Vector2 CursorPosition
         {
@@ -95,23 +117,8 @@ namespace Aura.Veldrid
                 OnViewDrag(Window.MouseDelta);
         }
 
-        public Stream? OpenAssetFile(string resourceName)
-        {
-            if (AssetPath == null)
-                return null;
-            var fullPath = Path.Combine(AssetPath, resourceName);
-            try
-            {
-                return new FileStream(fullPath, FileMode.Open, FileAccess.Read);
-            }
-            catch(IOException)
-            {
-                return null;
-            }
-        }
-
-        public ITexture CreateImage(Stream stream) =>
-            new AuraTexture(ImageLoader.LoadImage(stream, Device), ownsTexture: true);
+        public ITexture CreateImage(Stream stream) => TextureCache.Acquire(stream);
+        public IReadOnlyList<ITexture> CreateImages(IReadOnlyList<Stream> streams) => TextureCache.AcquireAll(streams);
 
         public IVideoTexture CreateVideo(Stream stream) =>
             VideoTextureSet.CreateFromStream(stream);
@@ -120,6 +127,7 @@ namespace Aura.Veldrid
         {
             var worldRenderer = new PanoramaWorldRenderer(spriteCapacity, SpriteRendererCommon, Device.SwapchainFramebuffer);
             worldRenderer.WorldTexture = ImageLoader.LoadCubemap(stream, Device);
+            worldRenderer.IsActive = false;
             worldRenderer.WorldRendererSet = WorldRendererSet;
             return worldRenderer;
         }
@@ -127,6 +135,7 @@ namespace Aura.Veldrid
         public IPuzzleWorldRenderer CreatePuzzleRenderer(int spriteCapacity)
         {
             var worldRenderer = new PuzzleWorldRenderer(spriteCapacity, SpriteRendererCommon, Device.SwapchainFramebuffer);
+            worldRenderer.IsActive = false;
             worldRenderer.WorldRendererSet = WorldRendererSet;
             return worldRenderer;
         }
@@ -22,7 +22,8 @@ namespace Aura.Veldrid
 
             protected override void DisposeManaged()
             {
-                Parent.textures.Remove(this);
+                lock (Parent.setLock)
+                    Parent.textures.Remove(this);
                 VideoPlayer.Dispose();
             }
 
@@ -45,6 +46,7 @@ namespace Aura.Veldrid
             }
         }
 
+        private readonly object setLock = new object(); // videos may be created by background scene loads
         private GraphicsDevice device;
         private CommandList commandList;
         private Fence fence;
@@ -61,13 +63,19 @@ namespace Aura.Veldrid
         {
             commandList.Dispose();
             fence.Dispose();
-            foreach (var tex in textures)
+            foreach (var tex in Snapshot())
                 tex.Dispose();
         }
 
+        private VideoTexture[] Snapshot()
+        {
+            lock (setLock)
+                return textures.ToArray();
+        }
+
         public void Update(float timeDelta)
         {
-            foreach (var tex in textures)
+            foreach (var tex in Snapshot())
                 tex.VideoPlayer.Update(timeDelta);
         }
 
@@ -75,7 +83,7 @@ namespace Aura.Veldrid
         {
             fence.Reset();
             commandList.Begin();
-            foreach (var tex in textures)
+            foreach (var tex in Snapshot())
                 tex.VideoPlayer.Render(commandList);
             commandList.End();
             device.SubmitCommands(commandList, fence);
@@ -86,11 +94,12 @@ namespace Aura.Veldrid
         {
             var videoPlayer = new VideoPlayer(device, stream);
             var newTexture = new VideoTexture(this, videoPlayer);
-            textures.Add(newTexture);
+            lock (setLock)
+                textures.Add(newTexture);
             return newTexture;
         }
 
-        public IEnumerator<IVideoTexture> GetEnumerator() => textures.GetEnumerator();
-        IEnumerator IEnumerable.GetEnumerator() => textures.GetEnumerator();
+        public IEnumerator<IVideoTexture> GetEnumerator() => ((IEnumerable<IVideoTexture>)Snapshot()).GetEnumerator();
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
     }
 }
@@ -16,8 +16,10 @@ namespace Aura.Veldrid
         Matrix4x4 ViewMatrix { get; }
     }
 
+    /// <summary>Renderers may be added from background threads while the set is rendered</summary>
     public class WorldRendererSet : BaseDisposable, IEnumerable<IVeldridWorldRenderer>
     {
+        private readonly object setLock = new object();
         private GraphicsDevice device;
         private ISet<IVeldridWorldRenderer> renderers = new HashSet<IVeldridWorldRenderer>();
         private CommandList commandList;
@@ -36,12 +38,27 @@ namespace Aura.Veldrid
             fence.Dispose();
         }
 
-        public void Add(IVeldridWorldRenderer ren) => renderers.Add(ren);
-        public void Remove(IVeldridWorldRenderer ren) => renderers.Remove(ren);
+        public void Add(IVeldridWorldRenderer ren)
+        {
+            lock (setLock)
+                renderers.Add(ren);
+        }
+
+        public void Remove(IVeldridWorldRenderer ren)
+        {
+            lock (setLock)
+                renderers.Remove(ren);
+        }
+
+        private IVeldridWorldRenderer[] Snapshot()
+        {
+            lock (setLock)
+                return renderers.ToArray();
+        }
 
         public void RenderAll()
         {
-            var sortedRenderers = renderers
+            var sortedRenderers = Snapshot()
                 .Where(r => r.IsActive)
                 .OrderBy(r => r.Order)
                 .ToArray();
@@ -57,7 +74,7 @@ namespace Aura.Veldrid
             device.WaitForFence(fence);
         }
 
-        public IEnumerator<IVeldridWorldRenderer> GetEnumerator() => renderers.GetEnumerator();
-        IEnumerator IEnumerable.GetEnumerator() => renderers.GetEnumerator();
+        public IEnumerator<IVeldridWorldRenderer> GetEnumerator() => ((IEnumerable<IVeldridWorldRenderer>)Snapshot()).GetEnumerator();
+        IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
     }
 }
@@ -9,6 +9,21 @@ using System.Runtime.InteropServices;
 
 namespace Aura.Veldrid
 {
+    public class DecodedImage
+    {
+        public int Width { get; }
+        public int Height { get; }
+        /// <summary>Tightly packed RGBA pixels</summary>
+        public byte[] Pixels { get; }
+
+        public DecodedImage(int width, int height, byte[] pixels)
+        {
+            Width = width;
+            Height = height;
+            Pixels = pixels;
+        }
+    }
+
     public unsafe class ImageLoader : BaseDisposable
     {
         private AVFormatContextPtr format = new AVFormatContextPtr();
@@ -99,7 +114,11 @@ namespace Aura.Veldrid
             return LoadCubemap(stream, gd);
         }
 
-        public static Texture LoadImage(Stream stream, GraphicsDevice gd)
+        public static Texture LoadImage(Stream stream, GraphicsDevice gd) =>
+            UploadImages(new[] { DecodeImage(stream) }, gd).Single();
+
+        /// <summary>Decodes the first frame of an image on the CPU, can be called concurrently</summary>
+        public static DecodedImage DecodeImage(Stream stream)
         {
             using var me = new ImageLoader(stream);
             if (!me.MoveToNextFrame())
@@ -108,23 +127,58 @@ namespace Aura.Veldrid
             if (me.convertedFrame == null)
                 throw new InvalidProgramException("Frame was not converted");
 
-            var texture = gd.ResourceFactory.CreateTexture(new TextureDescription
+            var pixels = new byte[me.Width * me.Height * 4];
+            Marshal.Copy(new IntPtr(me.convertedFrame.Ptr->data[0]), pixels, 0, pixels.Length);
+            return new DecodedImage(me.Width, me.Height, pixels);
+        }
+
+        /// <summary>Uploads decoded images through staging textures with a single command list</summary>
+        public static Texture[] UploadImages(IReadOnlyList<DecodedImage> images, GraphicsDevice gd)
+        {
+            var textures = new Texture[images.Count];
+            var stagings = new Texture[images.Count];
+            using var commandList = gd.ResourceFactory.CreateCommandList();
+            using var fence = gd.ResourceFactory.CreateFence(false);
+            try
             {
-                Width = (uint)me.Width,
-                Height = (uint)me.Height,
-                Depth = 1,
-                Format = PixelFormat.R8_G8_B8_A8_UNorm,
-                MipLevels = 1,
-                ArrayLayers = 1,
-                Type = TextureType.Texture2D,
-                Usage = TextureUsage.Sampled
-            });
-            gd.UpdateTexture(texture,
-                new IntPtr(me.convertedFrame.Ptr->data[0]), (uint)(me.Width * me.Height * 4),
-                0, 0, 0, (uint)me.Width, (uint)me.Height, 1, // area to update
-                0, 0); // mipmapLevel, arrayLevel
-            me.Dispose();
-            return texture;
+                commandList.Begin();
+                for (int i = 0; i < images.Count; i++)
+                {
+                    var description = new TextureDescription
+                    {
+                        Width = (uint)images[i].Width,
+                        Height = (uint)images[i].Height,
+                        Depth = 1,
+                        Format = PixelFormat.R8_G8_B8_A8_UNorm,
+                        MipLevels = 1,
+                        ArrayLayers = 1,
+                        Type = TextureType.Texture2D,
+                        Usage = TextureUsage.Staging
+                    };
+                    stagings[i] = gd.ResourceFactory.CreateTexture(description);
+                    gd.UpdateTexture(stagings[i], images[i].Pixels,
+                        0, 0, 0, description.Width, description.Height, 1, // area to update
+                        0, 0); // mipmapLevel, arrayLevel
+                    description.Usage = TextureUsage.Sampled;
+                    textures[i] = gd.ResourceFactory.CreateTexture(description);
+                    commandList.CopyTexture(stagings[i], textures[i]);
+                }
+                commandList.End();
+                gd.SubmitCommands(commandList, fence);
+                gd.WaitForFence(fence);
+                return textures;
+            }
+            catch
+            {
+                foreach (var texture in textures)
+                    texture?.Dispose();
+                throw;
+            }
+            finally
+            {
+                foreach (var staging in stagings)
+                    staging?.Dispose();
+            }
         }
 
         public static Texture LoadCubemap(Stream stream, GraphicsDevice gd)
@@ -36,6 +36,10 @@ namespace Aura.Veldrid
             return buffer;
         }
 
+        /// <summary>Size of an RGBA8 texture with a single mip level</summary>
+        public static long GetSizeInBytes(this Texture texture) =>
+            (long)texture.Width * texture.Height * texture.Depth * texture.ArrayLayers * 4;
+
         public static RgbaFloat WithAlpha(this RgbaFloat c, float alpha) =>
             new RgbaFloat(c.R, c.G, c.B, alpha);
 
@@ -11,6 +11,7 @@ namespace Aura.Veldrid
     {
         public bool IsActive { get; set; } = true;
         public int Order { get; set; } = 10000;
+        public long MemorySize => 0; // never retained with a scene
 
         private readonly ResourceLayoutDescription resourceLayoutDescr = new ResourceLayoutDescription
         {
@@ -48,6 +48,12 @@ namespace Aura.Veldrid
             window.CursorVisible = false;
             var backend = new VeldridBackend(window, graphicsDevice);
             backend.AssetPath = @"C:\Program Files (x86)\Steam\steamapps\common\Aura Fate of the Ages";
+            backend.CachePath = Path.Combine(Environment.GetFolderPath(Environment.SpecialFolder.LocalApplicationData), "ReAura", "cache");
+            int traceArgI = Array.IndexOf(args, "--trace-assets");
+            if (traceArgI >= 0 && traceArgI + 1 < args.Length)
+                backend.FileSystem.Tracer = new AssetAccessTracer(new StreamWriter(args[traceArgI + 1]));
+            int startupTraceArgI = Array.IndexOf(args, "--trace-startup");
+            string? startupTracePath = startupTraceArgI >= 0 && startupTraceArgI + 1 < args.Length ? args[startupTraceArgI + 1] : null;
             var game = new Game(backend,
                 new DebugCellSystem(backend));
 
@@ -73,12 +79,19 @@ namespace Aura.Veldrid
                 game.Update(time.Delta);
                 backend.Render();
                 graphicsDevice.SwapBuffers();
+                if (startupTracePath != null && game.IsInitialized)
+                {
+                    using (var startupTraceWriter = new StreamWriter(startupTracePath))
+                        game.StartupTrace.Write(startupTraceWriter);
+                    startupTracePath = null;
+                }
                 inputSnapshot = window.PumpEvents(); // pump events after swapbuffers in case the window got destroyed
                 backend.CurrentInput = inputSnapshot;
 
                 time.EndFrame();
             }
 
+            backend.FileSystem.Tracer?.Dispose();
             graphicsDevice.Dispose();
         }
     }
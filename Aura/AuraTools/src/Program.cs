@@ -0,0 +1,271 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Threading.Tasks;
+
+namespace Aura.Tools
+{
+    class Program
+    {
+        static int Main(string[] args)
+        {
+            if (args.Length < 1)
+                return PrintUsage();
+            try
+            {
+                switch (args[0])
+                {
+                    case "repack": return Repack(args.Skip(1).ToArray());
+                    case "extract": return Extract(args.Skip(1).ToArray());
+                    case "relayout": return Relayout(args.Skip(1).ToArray());
+                    default: return PrintUsage();
+                }
+            }
+            catch (ArgumentException e)
+            {
+                Console.Error.WriteLine($"Error: {e.Message}");
+                return PrintUsage();
+            }
+            catch (Exception e) when (e is IOException || e is InvalidDataException || e is UnauthorizedAccessException)
+            {
+                Console.Error.WriteLine($"Error: {e.Message}");
+                return 1;
+            }
+            catch (AggregateException e) // from parallel scenes
+            {
+                foreach (var inner in e.Flatten().InnerExceptions)
+                    Console.Error.WriteLine($"Error: {inner.Message}");
+                return 1;
+            }
+        }
+
+        static int PrintUsage()
+        {
+            Console.Error.WriteLine("usage: AuraTools repack [--compress] <game directory> [scene...]");
+            Console.Error.WriteLine("       AuraTools extract [--output <directory>] [--jobs <count>] <game directory> [scene...]");
+            Console.Error.WriteLine("       AuraTools relayout <game directory> <asset trace>...");
+            Console.Error.WriteLine("  repack   converts the scene packs into native packs (.anp) next to the originals");
+            Console.Error.WriteLine("  extract  writes all pack entries to <output>/<scene>/<scene><ext>/, scripts are decoded to text");
+            Console.Error.WriteLine("  relayout reorders the scene asset packs by co-occurrence and first use in the traces, originals are kept as .orig");
+            return 2;
+        }
+
+        static string? TakeOption(List<string> args, string name)
+        {
+            int index = args.IndexOf(name);
+            if (index < 0)
+                return null;
+            if (index + 1 >= args.Count)
+                throw new ArgumentException($"Missing value for {name}");
+            var value = args[index + 1];
+            args.RemoveRange(index, 2);
+            return value;
+        }
+
+        static IEnumerable<string> FindScenes(string gameDir, IReadOnlyCollection<string> sceneFilter)
+        {
+            var scenesDir = Path.Combine(gameDir, "Scenes");
+            if (!Directory.Exists(scenesDir))
+                throw new DirectoryNotFoundException($"Could not find scene directory {scenesDir}");
+            return Directory.GetDirectories(scenesDir)
+                .Select(Path.GetFileName)
+                .Select(n => n!)
+                .Where(n => sceneFilter.Count == 0 || sceneFilter.Contains(n, StringComparer.OrdinalIgnoreCase))
+                .OrderBy(n => n, StringComparer.OrdinalIgnoreCase);
+        }
+
+        static int Repack(string[] args)
+        {
+            bool compress = args.Contains("--compress");
+            var positional = args.Where(a => !a.StartsWith("--")).ToArray();
+            if (positional.Length < 1)
+                return PrintUsage();
+            var gameDir = positional[0];
+
+            foreach (var sceneName in FindScenes(gameDir, positional.Skip(1).ToArray()))
+            {
+                var scenePath = Path.Combine(gameDir, "Scenes", sceneName, sceneName);
+                var scriptPackPath = scenePath + ".psc";
+                if (!File.Exists(scriptPackPath))
+                {
+                    Console.WriteLine($"Skipping {sceneName}, it has no script pack");
+                    continue;
+                }
+
+                var writer = new NativePackWriter() { Compress = compress };
+                writer.StampSources(scenePath);
+                foreach (var extension in new[] { ".psp", ".pvd" })
+                {
+                    if (!File.Exists(scenePath + extension))
+                        continue;
+                    using var assetPack = new PackArchive(File.OpenRead(scenePath + extension));
+                    foreach (var entry in assetPack.Entries)
+                    {
+                        using var stream = assetPack.OpenEntry(entry);
+                        var content = new byte[entry.Length];
+                        stream.CopyTo(new MemoryStream(content));
+                        writer.AddAsset(entry.Name, content);
+                    }
+                }
+                using (var scriptPack = new PackArchive(File.OpenRead(scriptPackPath), PackKind.Scripts))
+                {
+                    foreach (var entry in scriptPack.Entries)
+                        writer.AddScript(entry.Name, scriptPack.ReadScriptText(entry));
+                }
+
+                var nativePackPath = scenePath + ".anp";
+                var tempPath = nativePackPath + ".tmp";
+                using (var output = new FileStream(tempPath, FileMode.Create, FileAccess.Write))
+                    writer.Write(output);
+                File.Move(tempPath, nativePackPath, overwrite: true);
+                Console.WriteLine($"Repacked {sceneName} ({new FileInfo(nativePackPath).Length} bytes)");
+            }
+            return 0;
+        }
+
+        static int Extract(string[] argArray)
+        {
+            var args = argArray.ToList();
+            var outputDir = TakeOption(args, "--output") ?? "out";
+            var jobsOption = TakeOption(args, "--jobs");
+            int jobs = Environment.ProcessorCount;
+            if (jobsOption != null && (!int.TryParse(jobsOption, out jobs) || jobs < 1))
+                throw new ArgumentException($"Invalid job count {jobsOption}");
+            if (args.Count < 1 || args.Any(a => a.StartsWith("--")))
+                return PrintUsage();
+            var gameDir = args[0];
+
+            // every job streams one scene at a time, so the memory use is bounded by the job count
+            var scenes = FindScenes(gameDir, args.Skip(1).ToArray()).ToArray();
+            var options = new ParallelOptions() { MaxDegreeOfParallelism = jobs };
+            Parallel.ForEach(scenes, options, sceneName =>
+            {
+                var scenePath = Path.Combine(gameDir, "Scenes", sceneName, sceneName);
+                int fileCount = 0;
+                foreach (var extension in new[] { ".psp", ".pvd", ".psc" })
+                {
+                    if (!File.Exists(scenePath + extension))
+                        continue;
+                    var kind = extension == ".psc" ? PackKind.Scripts : PackKind.Assets;
+                    using var pack = new PackArchive(File.OpenRead(scenePath + extension), kind);
+                    var packOutputDir = Path.Combine(outputDir, sceneName, sceneName + extension);
+                    Directory.CreateDirectory(packOutputDir);
+                    foreach (var entry in pack.Entries)
+                    {
+                        if (kind == PackKind.Scripts)
+                            File.WriteAllText(Path.Combine(packOutputDir, entry.Name + ".txt"), pack.ReadScriptText(entry));
+                        else
+                        {
+                            using var input = pack.OpenEntry(entry);
+                            using var output = new FileStream(Path.Combine(packOutputDir, entry.Name), FileMode.Create, FileAccess.Write);
+                            input.CopyTo(output);
+                        }
+                    }
+                    fileCount += pack.Entries.Count;
+                }
+                Console.WriteLine($"Extracted {sceneName} ({fileCount} files)");
+            });
+            return 0;
+        }
+
+        /// <summary>Averages the relative position of the first use of every scene asset in each visit of the scene</summary>
+        /// <remarks>Also returns the visits an asset was used in, assets with the same visits are always used together</remarks>
+        static Dictionary<string, (double rank, string visits)> ScoreFirstUses(IEnumerable<string> tracePaths)
+        {
+            var rankSums = new Dictionary<string, (double sum, int count)>(StringComparer.OrdinalIgnoreCase);
+            var assetVisits = new Dictionary<string, List<int>>(StringComparer.OrdinalIgnoreCase);
+            int visitCount = 0;
+            foreach (var tracePath in tracePaths)
+            {
+                using var reader = new StreamReader(tracePath);
+                var visit = new List<string>();
+                var visited = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+                string? visitScene = null;
+                void EndVisit()
+                {
+                    for (int i = 0; i < visit.Count; i++)
+                    {
+                        var (sum, count) = rankSums.GetValueOrDefault(visit[i]);
+                        rankSums[visit[i]] = (sum + (double)i / visit.Count, count + 1);
+                        if (!assetVisits.TryGetValue(visit[i], out var visits))
+                            assetVisits.Add(visit[i], visits = new List<int>());
+                        visits.Add(visitCount);
+                    }
+                    if (visit.Count > 0)
+                        visitCount++;
+                    visit.Clear();
+                    visited.Clear();
+                }
+
+                foreach (var access in AssetAccessTracer.ReadTrace(reader))
+                {
+                    if (access.Scene != visitScene)
+                    {
+                        EndVisit();
+                        visitScene = access.Scene;
+                    }
+                    var path = access.Path.Replace('\\', '/');
+                    if (visited.Add(path))
+                        visit.Add(path);
+                }
+                EndVisit();
+            }
+            return rankSums.ToDictionary(
+                p => p.Key,
+                p => (p.Value.sum / p.Value.count, string.Join(",", assetVisits[p.Key])),
+                StringComparer.OrdinalIgnoreCase);
+        }
+
+        static int Relayout(string[] args)
+        {
+            if (args.Length < 2)
+                return PrintUsage();
+            var gameDir = args[0];
+            var uses = ScoreFirstUses(args.Skip(1));
+
+            foreach (var sceneName in FindScenes(gameDir, Array.Empty<string>()))
+            {
+                var scenePath = Path.Combine(gameDir, "Scenes", sceneName, sceneName);
+                foreach (var extension in new[] { ".psp", ".pvd" })
+                {
+                    var packPath = scenePath + extension;
+                    if (!File.Exists(packPath))
+                        continue;
+                    var tempPath = packPath + ".tmp";
+                    using (var pack = new PackArchive(File.OpenRead(packPath)))
+                    {
+                        // entries used in the same visits are grouped, so assets needed together are read from one region,
+                        // groups follow their earliest first use and unused entries keep their original order after all used ones
+                        var entries = pack.Entries
+                            .Select((entry, index) => (entry, index, use: uses.GetValueOrDefault($"Scenes/{sceneName}/{entry.Name}", (rank: double.PositiveInfinity, visits: ""))))
+                            .GroupBy(e => e.use.visits)
+                            .OrderBy(g => g.Min(e => e.use.rank))
+                            .ThenBy(g => g.Min(e => e.index))
+                            .SelectMany(g => g.OrderBy(e => e.use.rank).ThenBy(e => e.index))
+                            .ToArray();
+                        if (entries.Select(e => e.index).SequenceEqual(Enumerable.Range(0, entries.Length)))
+                            continue;
+
+                        using var output = new FileStream(tempPath, FileMode.Create, FileAccess.Write);
+                        var writer = new PackFileWriter(output);
+                        writer.WriteFileList(entries.Select(e => e.entry.Name).ToArray());
+                        foreach (var (entry, _, _) in entries)
+                        {
+                            using var content = pack.OpenEntry(entry);
+                            writer.WriteAssetEntry(content, entry.Length);
+                        }
+                    }
+
+                    var backupPath = packPath + ".orig";
+                    if (File.Exists(backupPath))
+                        File.Move(tempPath, packPath, overwrite: true);
+                    else
+                        File.Replace(tempPath, packPath, backupPath);
+                    Console.WriteLine($"Reordered {sceneName}{extension}");
+                }
+            }
+            return 0;
+        }
+    }
+}